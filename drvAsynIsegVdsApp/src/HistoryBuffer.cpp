@@ -0,0 +1,99 @@
+//******************************************************************************
+// Copyright (C) 2014 Florian Feldbauer <florian@ep1.ruhr-uni-bochum.de>
+//                    - Helmholtz-Institut/University Mainz, Institute for nuclear physics
+//
+// This file is part of drvAsynIsegVds
+//
+// drvAsynIsegVds is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// drvAsynIsegVds is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+//
+// version 1.0.0; Aug. 15, 2014
+//******************************************************************************
+
+//_____ I N C L U D E S _______________________________________________________
+
+// local includes
+#include "HistoryBuffer.h"
+
+//_____ D E F I N I T I O N S __________________________________________________
+
+//_____ G L O B A L S __________________________________________________________
+
+//_____ L O C A L S ____________________________________________________________
+
+//_____ F U N C T I O N S ______________________________________________________
+
+//------------------------------------------------------------------------------
+HistoryBuffer::HistoryBuffer()
+  : _written( 0 ),
+    _frozen( false )
+{}
+
+//------------------------------------------------------------------------------
+//! @brief   Set the number of samples kept, drops the content
+//! @param   [in]  capacity  number of samples (0: disabled)
+//------------------------------------------------------------------------------
+void HistoryBuffer::resize( size_t capacity ) {
+  _data.assign( capacity, 0. );
+  rearm();
+}
+
+//------------------------------------------------------------------------------
+//! @brief   Drop the content and accept new samples again
+//------------------------------------------------------------------------------
+void HistoryBuffer::rearm() {
+  _written = 0;
+  _frozen  = false;
+}
+
+//------------------------------------------------------------------------------
+//! @brief   Append a sample, overwrites the oldest one if the buffer is full
+//------------------------------------------------------------------------------
+void HistoryBuffer::push( double value ) {
+  if( _frozen || _data.empty() ) return;
+  _data[_written % _data.size()] = value;
+  // the sample has to be visible before the counter
+  __sync_synchronize();
+  _written = _written + 1;
+}
+
+//------------------------------------------------------------------------------
+//! @brief   Copy the latest samples, the oldest first
+//!
+//! @param   [out] dest       buffer receiving the samples
+//! @param   [in]  nElements  size of dest
+//!
+//! @return  number of samples copied
+//------------------------------------------------------------------------------
+size_t HistoryBuffer::copy( double *dest, size_t nElements ) const {
+  const size_t size = _data.size();
+  const unsigned long end = _written;
+  __sync_synchronize();
+
+  size_t n = ( end < size ) ? end : size;
+  if( nElements < n ) n = nElements;
+  const unsigned long first = end - n;
+  for( size_t i = 0; i < n; ++i ) dest[i] = _data[( first + i ) % size];
+
+  // samples the producer overwrote while copying are dropped, including
+  // the slot of a push in progress, which is written before the counter
+  __sync_synchronize();
+  const unsigned long now = _written;
+  if( now < end ) return 0;  // rearmed meanwhile
+  if( now + 1 - first <= size ) return n;
+  const size_t lost = now + 1 - first - size;
+  if( lost >= n ) return 0;
+  for( size_t i = lost; i < n; ++i ) dest[i - lost] = dest[i];
+  return n - lost;
+}
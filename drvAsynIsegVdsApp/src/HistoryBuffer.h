@@ -0,0 +1,60 @@
+//******************************************************************************
+// Copyright (C) 2014 Florian Feldbauer <florian@ep1.ruhr-uni-bochum.de>
+//                    - Helmholtz-Institut/University Mainz, Institute for nuclear physics
+//
+// This file is part of drvAsynIsegVds
+//
+// drvAsynIsegVds is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// drvAsynIsegVds is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+//
+// version 1.0.0; Aug. 15, 2014
+//******************************************************************************
+
+#ifndef __HISTORY_BUFFER_H__
+#define __HISTORY_BUFFER_H__
+
+//_____ I N C L U D E S _______________________________________________________
+#include <cstddef>
+#include <vector>
+
+//_____ D E F I N I T I O N S __________________________________________________
+
+//! @brief   Fixed size ring buffer of the latest samples of a value
+//!
+//! One producer pushes samples, a consumer may copy the buffer at the same
+//! time without a lock: the producer publishes a sample by incrementing
+//! the sample counter after storing it, the consumer drops samples which
+//! were overwritten while it copied. resize() and rearm() must not run
+//! concurrently with push(). A frozen buffer ignores new samples and keeps
+//! its content, e.g. as pre-trigger capture of a trip.
+class HistoryBuffer {
+ public:
+  HistoryBuffer();
+
+  void resize( size_t capacity );
+  void push( double value );
+  size_t copy( double *dest, size_t nElements ) const;
+
+  void freeze()        { _frozen = true; }
+  void rearm();
+  bool frozen() const  { return _frozen; }
+  size_t capacity() const { return _data.size(); }
+
+ private:
+  std::vector<double>     _data;
+  volatile unsigned long  _written;  //!< number of samples pushed since the last rearm
+  volatile bool           _frozen;
+};
+
+#endif
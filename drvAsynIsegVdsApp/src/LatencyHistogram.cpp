@@ -0,0 +1,137 @@
+//******************************************************************************
+// Copyright (C) 2014 Florian Feldbauer <florian@ep1.ruhr-uni-bochum.de>
+//                    - Helmholtz-Institut/University Mainz, Institute for nuclear physics
+//
+// This file is part of drvAsynIsegVds
+//
+// drvAsynIsegVds is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// drvAsynIsegVds is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+//
+// version 1.0.0; Aug. 15, 2014
+//******************************************************************************
+
+//_____ I N C L U D E S _______________________________________________________
+
+// local includes
+#include "LatencyHistogram.h"
+
+//_____ D E F I N I T I O N S __________________________________________________
+
+//_____ G L O B A L S __________________________________________________________
+
+//_____ L O C A L S ____________________________________________________________
+
+//_____ F U N C T I O N S ______________________________________________________
+
+//------------------------------------------------------------------------------
+LatencyHistogram::LatencyHistogram() {
+  reset();
+}
+
+//------------------------------------------------------------------------------
+//! @brief   Clear all counters
+//------------------------------------------------------------------------------
+void LatencyHistogram::reset() {
+  for( int i = 0; i < NUM_BUCKETS; ++i ) _buckets[i] = 0;
+  _count  = 0;
+  _errors = 0;
+  _sum    = 0.;
+  _min    = 0.;
+  _max    = 0.;
+}
+
+//------------------------------------------------------------------------------
+//! @brief   Count a successful operation
+//! @param   [in]  seconds  duration of the operation
+//------------------------------------------------------------------------------
+void LatencyHistogram::add( double seconds ) {
+  double us = seconds * 1.e6;
+  if( us < 0. ) us = 0.;
+
+  int bucket = 0;
+  for( double edge = 1.; bucket < NUM_BUCKETS - 1 && us >= edge; edge *= 2. ) ++bucket;
+  ++_buckets[bucket];
+
+  if( 0 == _count || us < _min ) _min = us;
+  if( 0 == _count || us > _max ) _max = us;
+  _sum += us;
+  ++_count;
+}
+
+//------------------------------------------------------------------------------
+//! @brief   Count a successful operation started at start
+//------------------------------------------------------------------------------
+void LatencyHistogram::add( const epicsTimeStamp& start ) {
+  epicsTimeStamp now;
+  epicsTimeGetCurrent( &now );
+  add( epicsTimeDiffInSeconds( &now, &start ) );
+}
+
+//------------------------------------------------------------------------------
+//! @brief   Count a failed operation
+//------------------------------------------------------------------------------
+void LatencyHistogram::addError() {
+  ++_errors;
+}
+
+//------------------------------------------------------------------------------
+//! @brief   Min. latency in us
+//------------------------------------------------------------------------------
+double LatencyHistogram::min() const {
+  return _min;
+}
+
+//------------------------------------------------------------------------------
+//! @brief   Max. latency in us
+//------------------------------------------------------------------------------
+double LatencyHistogram::max() const {
+  return _max;
+}
+
+//------------------------------------------------------------------------------
+//! @brief   Average latency in us
+//------------------------------------------------------------------------------
+double LatencyHistogram::average() const {
+  return _count ? _sum / _count : 0.;
+}
+
+//------------------------------------------------------------------------------
+//! @brief   Estimate a percentile of the latency from the histogram
+//!
+//! Returns the upper edge of the bucket containing the percentile, limited
+//! to the max. latency seen.
+//!
+//! @param   [in]  fraction  e.g. 0.99 for the 99th percentile
+//! @return  latency in us
+//------------------------------------------------------------------------------
+double LatencyHistogram::percentile( double fraction ) const {
+  if( 0 == _count ) return 0.;
+
+  double needed = fraction * _count;
+  double edge = 1.;
+  unsigned long sum = 0;
+  for( int i = 0; i < NUM_BUCKETS - 1; ++i, edge *= 2. ) {
+    sum += _buckets[i];
+    if( sum >= needed ) return ( edge < _max ) ? edge : _max;
+  }
+  return _max;
+}
+
+//------------------------------------------------------------------------------
+//! @brief   Print the statistics in one line
+//------------------------------------------------------------------------------
+void LatencyHistogram::report( FILE *fp, const char *name ) const {
+  fprintf( fp, "  %-8s %10lu ops %6lu errors  min %9.1f  avg %9.1f  p99 %9.1f  max %9.1f us\n",
+           name, _count, _errors, min(), average(), percentile( 0.99 ), max() );
+}
@@ -0,0 +1,68 @@
+//******************************************************************************
+// Copyright (C) 2014 Florian Feldbauer <florian@ep1.ruhr-uni-bochum.de>
+//                    - Helmholtz-Institut/University Mainz, Institute for nuclear physics
+//
+// This file is part of drvAsynIsegVds
+//
+// drvAsynIsegVds is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// drvAsynIsegVds is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+//
+// version 1.0.0; Aug. 15, 2014
+//******************************************************************************
+
+#ifndef __LATENCY_HISTOGRAM_H__
+#define __LATENCY_HISTOGRAM_H__
+
+//_____ I N C L U D E S _______________________________________________________
+#include <cstdio>
+
+#include <epicsTime.h>
+
+//_____ D E F I N I T I O N S __________________________________________________
+
+//! @brief   Counter and fixed bucket histogram of operation latencies
+//!
+//! Bucket 0 counts latencies below 1 us, bucket i latencies from 2^(i-1) us
+//! up to 2^i us, the last bucket everything above. The class does no
+//! locking, it has to be protected by the lock of its owner.
+class LatencyHistogram {
+ public:
+  enum { NUM_BUCKETS = 24 };  //!< last regular bucket ends at 2^22 us (~4 s)
+
+  LatencyHistogram();
+
+  void add( double seconds );
+  void add( const epicsTimeStamp& start );
+  void addError();
+  void reset();
+
+  unsigned long count() const  { return _count; }   //!< number of successful operations
+  unsigned long errors() const { return _errors; }  //!< number of failed operations
+  double min() const;
+  double max() const;
+  double average() const;
+  double percentile( double fraction ) const;
+
+  void report( FILE *fp, const char *name ) const;
+
+ private:
+  unsigned long _buckets[NUM_BUCKETS];
+  unsigned long _count;
+  unsigned long _errors;
+  double        _sum;  //!< sum of all latencies in us
+  double        _min;  //!< min. latency in us
+  double        _max;  //!< max. latency in us
+};
+
+#endif
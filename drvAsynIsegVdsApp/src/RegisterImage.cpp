@@ -0,0 +1,219 @@
+//******************************************************************************
+// Copyright (C) 2014 Florian Feldbauer <florian@ep1.ruhr-uni-bochum.de>
+//                    - Helmholtz-Institut/University Mainz, Institute for nuclear physics
+//
+// This file is part of drvAsynIsegVds
+//
+// drvAsynIsegVds is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// drvAsynIsegVds is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+//
+// version 1.0.0; Aug. 15, 2014
+//******************************************************************************
+
+//_____ I N C L U D E S _______________________________________________________
+
+// ANSI C/C++ includes
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// local includes
+#include "RegisterImage.h"
+
+//_____ D E F I N I T I O N S __________________________________________________
+
+//_____ G L O B A L S __________________________________________________________
+
+//_____ L O C A L S ____________________________________________________________
+
+//_____ F U N C T I O N S ______________________________________________________
+
+//------------------------------------------------------------------------------
+RegisterImage::RegisterImage() {
+  memset( &_header, 0, sizeof( _header ) );
+}
+
+//------------------------------------------------------------------------------
+//! @brief   Set the layout and clear all register words
+//!
+//! @param   [in]  layout       checksum of the register descriptor table
+//! @param   [in]  modules      number of modules
+//! @param   [in]  channels     channels per module
+//! @param   [in]  moduleWords  size of the module register block in words
+//! @param   [in]  chanWords    size of a channel register block in words
+//! @param   [in]  chanBase     address of the block of channel 0
+//! @param   [in]  chanStride   distance of two channel blocks in bytes
+//------------------------------------------------------------------------------
+void RegisterImage::init( epicsUInt32 layout, epicsUInt32 modules, epicsUInt32 channels, epicsUInt32 moduleWords,
+                          epicsUInt32 chanWords, epicsUInt32 chanBase, epicsUInt32 chanStride ) {
+  memset( &_header, 0, sizeof( _header ) );
+  strncpy( _header.magic, REGISTER_IMAGE_MAGIC, sizeof( _header.magic ) );
+  _header.version     = REGISTER_IMAGE_VERSION;
+  _header.layout      = layout;
+  _header.modules     = modules;
+  _header.channels    = channels;
+  _header.moduleWords = moduleWords;
+  _header.chanWords   = chanWords;
+  _header.chanBase    = chanBase;
+  _header.chanStride  = chanStride;
+  _words.assign( modules * stride(), 0 );
+}
+
+//------------------------------------------------------------------------------
+//! @brief   Set the time the image was taken
+//------------------------------------------------------------------------------
+void RegisterImage::setTime( epicsUInt32 secPastEpoch, epicsUInt32 nsec ) {
+  _header.secPastEpoch = secPastEpoch;
+  _header.nsec         = nsec;
+}
+
+//------------------------------------------------------------------------------
+//! @brief   Register block of a channel
+//------------------------------------------------------------------------------
+epicsUInt32* RegisterImage::chanBlock( size_t module, size_t ch ) {
+  return moduleBlock( module ) + _header.moduleWords + ch * _header.chanWords;
+}
+
+//------------------------------------------------------------------------------
+//! @brief   Register block of a channel
+//------------------------------------------------------------------------------
+const epicsUInt32* RegisterImage::chanBlock( size_t module, size_t ch ) const {
+  return moduleBlock( module ) + _header.moduleWords + ch * _header.chanWords;
+}
+
+//------------------------------------------------------------------------------
+//! @brief   VME address relative to the base address of a word of a module
+//!
+//! @param   [in]  word  index of the word, counted from the module block
+//------------------------------------------------------------------------------
+epicsUInt32 RegisterImage::vmeAddress( size_t word ) const {
+  if( word < _header.moduleWords ) return 4 * word;
+  word -= _header.moduleWords;
+  return _header.chanBase + ( word / _header.chanWords ) * _header.chanStride + 4 * ( word % _header.chanWords );
+}
+
+//------------------------------------------------------------------------------
+//! @brief   Index of the module with a base address
+//! @return  -1 if the image has no such module
+//------------------------------------------------------------------------------
+int RegisterImage::findModule( epicsUInt32 address ) const {
+  for( size_t module = 0; module < _header.modules; ++module )
+    if( base( module ) == address ) return module;
+  return -1;
+}
+
+//------------------------------------------------------------------------------
+//! @brief   Check if two images have the same register layout
+//------------------------------------------------------------------------------
+bool RegisterImage::compatible( const RegisterImage& other ) const {
+  return other._header.layout      == _header.layout &&
+         other._header.channels    == _header.channels &&
+         other._header.moduleWords == _header.moduleWords &&
+         other._header.chanWords   == _header.chanWords &&
+         other._header.chanBase    == _header.chanBase &&
+         other._header.chanStride  == _header.chanStride;
+}
+
+//------------------------------------------------------------------------------
+//! @brief   Read an image file
+//!
+//! @param   [in]  path   name of the file
+//! @param   [out] error  reason if the file could not be read
+//!
+//! @return  false if the file is missing, truncated, corrupt or of another version
+//------------------------------------------------------------------------------
+bool RegisterImage::read( const char *path, std::string& error ) {
+  FILE *fp = fopen( path, "rb" );
+  if( !fp ) {
+    error = strerror( errno );
+    return false;
+  }
+
+  registerImageHeader header;
+  bool ok = ( 1 == fread( &header, sizeof( header ), 1, fp ) );
+  if( !ok ) error = "truncated header";
+  else if( strncmp( header.magic, REGISTER_IMAGE_MAGIC, sizeof( header.magic ) ) ) {
+    error = "no register image";
+    ok = false;
+  } else if( REGISTER_IMAGE_VERSION != header.version ) {
+    error = "unsupported version";
+    ok = false;
+  }
+
+  // check the sizes against the file before allocating, a corrupt file
+  // must not make the words overflow or exhaust memory
+  if( ok ) {
+    struct stat st;
+    unsigned long long available = 0;
+    if( 0 == fstat( fileno( fp ), &st ) && st.st_size > (off_t)sizeof( header ) )
+      available = ( st.st_size - sizeof( header ) ) / sizeof( epicsUInt32 );
+    const unsigned long long words = 2ULL + header.moduleWords + (unsigned long long)header.channels * header.chanWords;
+    if( header.modules && ( words > available || header.modules > available / words ) ) {
+      error = "sizes in header exceed the file";
+      ok = false;
+    }
+  }
+
+  if( ok ) {
+    _header = header;
+    _words.assign( _header.modules * stride(), 0 );
+    if( !_words.empty() && _words.size() != fread( &_words[0], sizeof( epicsUInt32 ), _words.size(), fp ) ) {
+      error = "truncated register words";
+      ok = false;
+    }
+  }
+  fclose( fp );
+  return ok;
+}
+
+//------------------------------------------------------------------------------
+//! @brief   Write the image to a file
+//!
+//! Writes a temporary file next to it and renames it, an existing file is
+//! replaced atomically.
+//!
+//! @param   [in]  path   name of the file
+//! @param   [out] error  reason if the file could not be written
+//------------------------------------------------------------------------------
+bool RegisterImage::write( const char *path, std::string& error ) const {
+  std::string temp( path );
+  temp += ".tmp";
+
+  int fd = open( temp.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644 );
+  if( fd < 0 ) {
+    error = strerror( errno );
+    return false;
+  }
+
+  // header and words as one buffer, written at once
+  std::vector<char> buffer( sizeof( _header ) + _words.size() * sizeof( epicsUInt32 ) );
+  memcpy( &buffer[0], &_header, sizeof( _header ) );
+  if( !_words.empty() ) memcpy( &buffer[sizeof( _header )], &_words[0], _words.size() * sizeof( epicsUInt32 ) );
+
+  bool ok = ( (ssize_t)buffer.size() == ::write( fd, &buffer[0], buffer.size() ) ) && 0 == fsync( fd );
+  if( !ok ) error = strerror( errno );
+  if( 0 != close( fd ) && ok ) {
+    error = strerror( errno );
+    ok = false;
+  }
+  if( ok && 0 != rename( temp.c_str(), path ) ) {
+    error = strerror( errno );
+    ok = false;
+  }
+  if( !ok ) unlink( temp.c_str() );
+  return ok;
+}
@@ -0,0 +1,92 @@
+//******************************************************************************
+// Copyright (C) 2014 Florian Feldbauer <florian@ep1.ruhr-uni-bochum.de>
+//                    - Helmholtz-Institut/University Mainz, Institute for nuclear physics
+//
+// This file is part of drvAsynIsegVds
+//
+// drvAsynIsegVds is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// drvAsynIsegVds is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+//
+// version 1.0.0; Aug. 15, 2014
+//******************************************************************************
+
+#ifndef __REGISTER_IMAGE_H__
+#define __REGISTER_IMAGE_H__
+
+//_____ I N C L U D E S _______________________________________________________
+#include <string>
+#include <vector>
+
+#include <epicsTypes.h>
+
+//_____ D E F I N I T I O N S __________________________________________________
+
+#define REGISTER_IMAGE_MAGIC    "ISEGVDS"  //!< first bytes of an image file
+#define REGISTER_IMAGE_VERSION  1          //!< version of the file format
+
+//! @brief   Header of a register image file
+typedef struct {
+  char        magic[8];      //!< REGISTER_IMAGE_MAGIC
+  epicsUInt32 version;       //!< REGISTER_IMAGE_VERSION
+  epicsUInt32 layout;        //!< checksum of the register descriptor table
+  epicsUInt32 modules;       //!< number of modules
+  epicsUInt32 channels;      //!< channels per module
+  epicsUInt32 moduleWords;   //!< size of the module register block in 32 bit words
+  epicsUInt32 chanWords;     //!< size of a channel register block in 32 bit words
+  epicsUInt32 chanBase;      //!< address of the block of channel 0 relative to the base address
+  epicsUInt32 chanStride;    //!< distance of the blocks of two channels in bytes
+  epicsUInt32 secPastEpoch;  //!< time the image was taken
+  epicsUInt32 nsec;
+} registerImageHeader;
+
+//! @brief   Raw register contents of all modules of a port
+//!
+//! The file holds the header followed by one record per module: base
+//! address, valid flag, module register block and the register blocks of
+//! all channels, all as 32 bit words in host byte order. It is written to
+//! a temporary file with one sequential write and renamed, so readers
+//! never see a partial image.
+class RegisterImage {
+ public:
+  RegisterImage();
+
+  void init( epicsUInt32 layout, epicsUInt32 modules, epicsUInt32 channels, epicsUInt32 moduleWords,
+             epicsUInt32 chanWords, epicsUInt32 chanBase, epicsUInt32 chanStride );
+  bool read( const char *path, std::string& error );
+  bool write( const char *path, std::string& error ) const;
+  bool compatible( const RegisterImage& other ) const;
+
+  const registerImageHeader& header() const { return _header; }
+  void setTime( epicsUInt32 secPastEpoch, epicsUInt32 nsec );
+
+  epicsUInt32& base( size_t module )   { return _words[module * stride()]; }
+  epicsUInt32  base( size_t module ) const { return _words[module * stride()]; }
+  epicsUInt32& valid( size_t module )  { return _words[module * stride() + 1]; }
+  epicsUInt32  valid( size_t module ) const { return _words[module * stride() + 1]; }
+  epicsUInt32* moduleBlock( size_t module ) { return &_words[module * stride() + 2]; }
+  const epicsUInt32* moduleBlock( size_t module ) const { return &_words[module * stride() + 2]; }
+  epicsUInt32* chanBlock( size_t module, size_t ch );
+  const epicsUInt32* chanBlock( size_t module, size_t ch ) const;
+  epicsUInt32 vmeAddress( size_t word ) const;
+  int findModule( epicsUInt32 base ) const;
+  size_t wordsPerModule() const { return stride() - 2; }
+
+ private:
+  size_t stride() const { return 2 + _header.moduleWords + _header.channels * _header.chanWords; }
+
+  registerImageHeader       _header;
+  std::vector<epicsUInt32>  _words;
+};
+
+#endif
@@ -26,25 +26,58 @@
 //******************************************************************************
 
 //_____ I N C L U D E S _______________________________________________________
+#include <cstring>
 #include <iostream>
 
+// EPICS includes
+#include <epicsExport.h>
+#include <iocsh.h>
+
+// local includes
 #include "VmeMaster.h"
 
 //_____ D E F I N I T I O N S __________________________________________________
 
 //_____ G L O B A L S __________________________________________________________
 VmeMaster* VmeMaster::_pinstance = NULL; 
+std::map<std::string, VmeMaster*> VmeMaster::_instances;
 
 //_____ L O C A L S ____________________________________________________________
 
 //_____ F U N C T I O N S ______________________________________________________
 
 
-VmeMaster::VmeMaster() {}
+VmeMaster::VmeMaster()
+  : _cycles( 0 ),
+    _bytes( 0 ),
+    _errors( 0 ),
+    _contentions( 0 ),
+    _linkDowns( 0 ),
+    _failures( 0 ),
+    _linkUp( 1 ),
+    _lastError( 0 )
+{}
 
 VmeMaster::~VmeMaster() {}
 
-VmeMaster::VmeMaster( const VmeMaster& rother ) {}
+//------------------------------------------------------------------------------
+//! @brief   Lock the link, count contention if it is held by another thread
+//------------------------------------------------------------------------------
+VmeMaster::LinkGuard::LinkGuard( VmeMaster& master )
+  : _master( master )
+{
+  if( !_master._linkLock.tryLock() ) {
+    __sync_fetch_and_add( &_master._contentions, 1UL );
+    epicsTimeStamp start;
+    epicsTimeGetCurrent( &start );
+    _master._linkLock.lock();
+    _master._linkWait.add( start );
+  }
+}
+
+VmeMaster::LinkGuard::~LinkGuard() {
+  _master._linkLock.unlock();
+}
 
 //------------------------------------------------------------------------------
 //! @brief   Get pointer to an instance of class VmeMaster 
@@ -56,6 +89,22 @@ VmeMaster* VmeMaster::getInstance() {
   return _pinstance; 
 }
 
+//------------------------------------------------------------------------------
+//! @brief   Get pointer to a named instance of class VmeMaster 
+//! @param   [in]  name  name of the link (NULL or empty: default link)
+//! @return  Address of instance, NULL if there is no link with this name
+//------------------------------------------------------------------------------
+VmeMaster* VmeMaster::getInstance( const char* name ) { 
+  if( !name || !name[0] ) return getInstance();
+
+  std::map<std::string, VmeMaster*>::const_iterator it = _instances.find( name );
+  if( it == _instances.end() ) {
+    std::cerr << "VmeMaster " << name << " has not been created" << std::endl;
+    return 0;
+  }
+  return it->second; 
+}
+
 //------------------------------------------------------------------------------
 //! @brief   Check if an instance exists 
 //! @return  true if instance exists, otherwise false
@@ -64,3 +113,467 @@ bool VmeMaster::exists() {
   return ( _pinstance != 0 );
 }
 
+//------------------------------------------------------------------------------
+//! @brief   Check if a named instance exists 
+//! @param   [in]  name  name of the link (NULL or empty: default link)
+//! @return  true if instance exists, otherwise false
+//------------------------------------------------------------------------------
+bool VmeMaster::exists( const char* name ) {
+  if( !name || !name[0] ) return exists();
+  return ( _instances.find( name ) != _instances.end() );
+}
+
+//------------------------------------------------------------------------------
+//! @brief   Register a new instance under its link name
+//!
+//! The first instance becomes the default link returned by getInstance().
+//!
+//! @param   [in]  name      name of the link
+//! @param   [in]  instance  the new instance
+//! @return  false if a link with this name already exists
+//------------------------------------------------------------------------------
+bool VmeMaster::addInstance( const char* name, VmeMaster* instance ) {
+  if( !_instances.insert( std::make_pair( std::string( name ), instance ) ).second )
+    return false;
+  if( !_pinstance ) _pinstance = instance;
+  return true;
+}
+
+//------------------------------------------------------------------------------
+//! @brief   Print the statistics of all links
+//------------------------------------------------------------------------------
+void VmeMaster::reportAll( FILE *fp, int details ) {
+  std::map<std::string, VmeMaster*>::const_iterator it;
+  for( it = _instances.begin(); it != _instances.end(); ++it ) {
+    fprintf( fp, "%s%s: ", it->first.c_str(), ( it->second == _pinstance ) ? " (default)" : "" );
+    it->second->report( fp, details );
+  }
+}
+
+
+//------------------------------------------------------------------------------
+//! @brief   Count a successful transfer
+//! @param   [in]  bytes  number of bytes transferred
+//------------------------------------------------------------------------------
+void VmeMaster::countTransfer( unsigned long bytes ) {
+  __sync_fetch_and_add( &_cycles, 1UL );
+  __sync_fetch_and_add( &_bytes, bytes );
+  if( _failures ) __sync_lock_test_and_set( &_failures, 0UL );
+}
+
+//------------------------------------------------------------------------------
+//! @brief   Count a failed transfer
+//!
+//! After linkDownThreshold failures in a row without a successful transfer
+//! the link is marked down. A single missing module does not trigger this,
+//! as long as other modules on the link answer.
+//!
+//! @param   [in]  error  errno of the failure (0: not known)
+//------------------------------------------------------------------------------
+void VmeMaster::countError( int error ) {
+  __sync_fetch_and_add( &_errors, 1UL );
+  if( error ) _lastError = error;
+  if( linkDownThreshold == __sync_add_and_fetch( &_failures, 1UL ) ) setLinkDown();
+}
+
+//------------------------------------------------------------------------------
+//! @brief   Keep the errno of a failure which is no transfer
+//!
+//! Unlike countError() the failure neither counts as error of the link
+//! nor brings the link down.
+//------------------------------------------------------------------------------
+void VmeMaster::keepError( int error ) {
+  if( error ) _lastError = error;
+}
+
+//------------------------------------------------------------------------------
+//! @brief   Check if the link is usable
+//!
+//! While the link is down all accessors fail without touching the VME
+//! master, until reconnect() succeeds.
+//------------------------------------------------------------------------------
+bool VmeMaster::isLinkUp() const {
+  return _linkUp;
+}
+
+//------------------------------------------------------------------------------
+//! @brief   Mark the link down
+//------------------------------------------------------------------------------
+void VmeMaster::setLinkDown() {
+  if( __sync_lock_test_and_set( &_linkUp, 0 ) ) {
+    __sync_fetch_and_add( &_linkDowns, 1UL );
+    if( _failures ) std::cerr << "VME link down after " << _failures << " failed transfers" << std::endl;
+    else            std::cerr << "VME link down" << std::endl;
+  }
+}
+
+//------------------------------------------------------------------------------
+//! @brief   errno of the last failed transfer, 0 if not known
+//------------------------------------------------------------------------------
+int VmeMaster::lastError() const {
+  return _lastError;
+}
+
+//------------------------------------------------------------------------------
+//! @brief   Bring the link up again
+//!
+//! The default implementation only clears the link down state, VME masters
+//! which can reopen their device should override it.
+//!
+//! @return  true if the link is up
+//------------------------------------------------------------------------------
+bool VmeMaster::reconnect() {
+  __sync_lock_test_and_set( &_failures, 0UL );
+  __sync_lock_test_and_set( &_linkUp, 1 );
+  return true;
+}
+
+//------------------------------------------------------------------------------
+//! @brief   Get a short description of a status
+//------------------------------------------------------------------------------
+const char* VmeMaster::statusString( Status status ) {
+  switch( status ) {
+    case SUCCESS:       return "Success";
+    case BUS_ERROR:     return "VME transfer failed";
+    case LINK_DOWN:     return "VME link down";
+    case NOT_SUPPORTED: return "Not supported by VME master";
+  }
+  return "Unknown status";
+}
+
+//------------------------------------------------------------------------------
+//! @brief   Throw the exception of the throwing accessors
+//! @param   [in]  status     status of the failed access
+//! @param   [in]  operation  e.g. "read from"
+//! @param   [in]  address    VME address
+//! @exception VmeException   always
+//------------------------------------------------------------------------------
+void VmeMaster::throwError( Status status, const char* operation, uint32_t address ) const {
+  char errmsg[255];
+  int error = _lastError;
+  if( BUS_ERROR == status && error )
+    sprintf( errmsg, "Could not %s VMEbus at 0x%08x: %s(%d)", operation, address, strerror( error ), error );
+  else
+    sprintf( errmsg, "Could not %s VMEbus at 0x%08x: %s", operation, address, statusString( status ) );
+  throw VmeException( errmsg );
+}
+
+//------------------------------------------------------------------------------
+
+void VmeMaster::writeRegisterA16D8 ( uint32_t baseAddress, uint32_t subAddress, uint8_t value ) {
+  Status status = tryWrite( A16, WIDTH8, baseAddress + subAddress, value );
+  if( status ) throwError( status, "write to", baseAddress + subAddress );
+}
+void VmeMaster::writeRegisterA16D16 ( uint32_t baseAddress, uint32_t subAddress, uint16_t value ) {
+  Status status = tryWrite( A16, WIDTH16, baseAddress + subAddress, value );
+  if( status ) throwError( status, "write to", baseAddress + subAddress );
+}
+void VmeMaster::writeRegisterA16D32 ( uint32_t baseAddress, uint32_t subAddress, uint32_t value ) {
+  Status status = tryWrite( A16, WIDTH32, baseAddress + subAddress, value );
+  if( status ) throwError( status, "write to", baseAddress + subAddress );
+}
+uint8_t VmeMaster::readRegisterA16D8 ( uint32_t baseAddress, uint32_t subAddress ) {
+  uint32_t value = 0xff;
+  Status status = tryRead( A16, WIDTH8, baseAddress + subAddress, value );
+  if( status ) throwError( status, "read from", baseAddress + subAddress );
+  return value;
+}
+uint16_t VmeMaster::readRegisterA16D16 ( uint32_t baseAddress, uint32_t subAddress ) {
+  uint32_t value = 0xff;
+  Status status = tryRead( A16, WIDTH16, baseAddress + subAddress, value );
+  if( status ) throwError( status, "read from", baseAddress + subAddress );
+  return value;
+}
+uint32_t VmeMaster::readRegisterA16D32 ( uint32_t baseAddress, uint32_t subAddress ) {
+  uint32_t value = 0xff;
+  Status status = tryRead( A16, WIDTH32, baseAddress + subAddress, value );
+  if( status ) throwError( status, "read from", baseAddress + subAddress );
+  return value;
+}
+void VmeMaster::writeRegisterA24D8 ( uint32_t baseAddress, uint32_t subAddress, uint8_t value ) {
+  Status status = tryWrite( A24, WIDTH8, baseAddress + subAddress, value );
+  if( status ) throwError( status, "write to", baseAddress + subAddress );
+}
+void VmeMaster::writeRegisterA24D16 ( uint32_t baseAddress, uint32_t subAddress, uint16_t value ) {
+  Status status = tryWrite( A24, WIDTH16, baseAddress + subAddress, value );
+  if( status ) throwError( status, "write to", baseAddress + subAddress );
+}
+void VmeMaster::writeRegisterA24D32 ( uint32_t baseAddress, uint32_t subAddress, uint32_t value ) {
+  Status status = tryWrite( A24, WIDTH32, baseAddress + subAddress, value );
+  if( status ) throwError( status, "write to", baseAddress + subAddress );
+}
+uint8_t VmeMaster::readRegisterA24D8 ( uint32_t baseAddress, uint32_t subAddress ) {
+  uint32_t value = 0xff;
+  Status status = tryRead( A24, WIDTH8, baseAddress + subAddress, value );
+  if( status ) throwError( status, "read from", baseAddress + subAddress );
+  return value;
+}
+uint16_t VmeMaster::readRegisterA24D16 ( uint32_t baseAddress, uint32_t subAddress ) {
+  uint32_t value = 0xff;
+  Status status = tryRead( A24, WIDTH16, baseAddress + subAddress, value );
+  if( status ) throwError( status, "read from", baseAddress + subAddress );
+  return value;
+}
+uint32_t VmeMaster::readRegisterA24D32 ( uint32_t baseAddress, uint32_t subAddress ) {
+  uint32_t value = 0xff;
+  Status status = tryRead( A24, WIDTH32, baseAddress + subAddress, value );
+  if( status ) throwError( status, "read from", baseAddress + subAddress );
+  return value;
+}
+void VmeMaster::writeRegisterA32D8 ( uint32_t baseAddress, uint32_t subAddress, uint8_t value ) {
+  Status status = tryWrite( A32, WIDTH8, baseAddress + subAddress, value );
+  if( status ) throwError( status, "write to", baseAddress + subAddress );
+}
+void VmeMaster::writeRegisterA32D16 ( uint32_t baseAddress, uint32_t subAddress, uint16_t value ) {
+  Status status = tryWrite( A32, WIDTH16, baseAddress + subAddress, value );
+  if( status ) throwError( status, "write to", baseAddress + subAddress );
+}
+void VmeMaster::writeRegisterA32D32 ( uint32_t baseAddress, uint32_t subAddress, uint32_t value ) {
+  Status status = tryWrite( A32, WIDTH32, baseAddress + subAddress, value );
+  if( status ) throwError( status, "write to", baseAddress + subAddress );
+}
+uint8_t VmeMaster::readRegisterA32D8 ( uint32_t baseAddress, uint32_t subAddress ) {
+  uint32_t value = 0xff;
+  Status status = tryRead( A32, WIDTH8, baseAddress + subAddress, value );
+  if( status ) throwError( status, "read from", baseAddress + subAddress );
+  return value;
+}
+uint16_t VmeMaster::readRegisterA32D16 ( uint32_t baseAddress, uint32_t subAddress ) {
+  uint32_t value = 0xff;
+  Status status = tryRead( A32, WIDTH16, baseAddress + subAddress, value );
+  if( status ) throwError( status, "read from", baseAddress + subAddress );
+  return value;
+}
+uint32_t VmeMaster::readRegisterA32D32 ( uint32_t baseAddress, uint32_t subAddress ) {
+  uint32_t value = 0xff;
+  Status status = tryRead( A32, WIDTH32, baseAddress + subAddress, value );
+  if( status ) throwError( status, "read from", baseAddress + subAddress );
+  return value;
+}
+
+//------------------------------------------------------------------------------
+//! @brief   Get a snapshot of the link statistics
+//!
+//! The counters are read one after another without locking, so they may
+//! be off by the transfers running while the snapshot is taken.
+//------------------------------------------------------------------------------
+VmeMaster::Statistics VmeMaster::getStatistics() const {
+  Statistics stats;
+  stats.cycles      = __sync_fetch_and_add( const_cast<volatile unsigned long*>( &_cycles ), 0UL );
+  stats.bytes       = __sync_fetch_and_add( const_cast<volatile unsigned long*>( &_bytes ), 0UL );
+  stats.errors      = __sync_fetch_and_add( const_cast<volatile unsigned long*>( &_errors ), 0UL );
+  stats.contentions = __sync_fetch_and_add( const_cast<volatile unsigned long*>( &_contentions ), 0UL );
+  stats.linkDowns   = __sync_fetch_and_add( const_cast<volatile unsigned long*>( &_linkDowns ), 0UL );
+  return stats;
+}
+
+//------------------------------------------------------------------------------
+//! @brief   Reset the link statistics
+//------------------------------------------------------------------------------
+void VmeMaster::resetStatistics() {
+  {
+    LinkGuard guard( *this );
+    _linkWait.reset();
+  }
+  __sync_lock_test_and_set( &_cycles, 0UL );
+  __sync_lock_test_and_set( &_bytes, 0UL );
+  __sync_lock_test_and_set( &_errors, 0UL );
+  __sync_lock_test_and_set( &_contentions, 0UL );
+  __sync_lock_test_and_set( &_linkDowns, 0UL );
+}
+
+//------------------------------------------------------------------------------
+//! @brief   Print the link statistics
+//! @param   [in]  fp       file to print to
+//! @param   [in]  details  level of detail (> 0: also show the link mutex)
+//------------------------------------------------------------------------------
+void VmeMaster::report( FILE *fp, int details ) {
+  Statistics stats = getStatistics();
+  LatencyHistogram linkWait;
+  {
+    LinkGuard guard( *this );
+    linkWait = _linkWait;
+  }
+  fprintf( fp, "VME link %s: %lu cycles, %lu bytes, %lu errors, %lu contentions, down %lu times\n",
+           isLinkUp() ? "up" : "down", stats.cycles, stats.bytes, stats.errors, stats.contentions,
+           stats.linkDowns );
+  linkWait.report( fp, "wait" );
+  if( details > 0 ) _linkLock.show( details );
+}
+
+//------------------------------------------------------------------------------
+//! @brief   Read a block of 32 bit registers with single cycles
+//!
+//! The link is locked for the whole block, so the block is not interleaved
+//! with accesses of other threads.
+//------------------------------------------------------------------------------
+VmeMaster::Status VmeMaster::tryBlockRead( AddressSpace space, TransferMode mode,
+                                           uint32_t baseAddress, uint32_t subAddress,
+                                           uint32_t wordsToRead, uint32_t* buffer ) {
+  if( !isLinkUp() ) return LINK_DOWN;
+  LinkGuard guard( *this );
+  for( uint32_t i = 0; i < wordsToRead; ++i ) {
+    Status status = tryRead( space, WIDTH32, baseAddress + subAddress + 4 * i, buffer[i] );
+    if( status ) return status;
+  }
+  return SUCCESS;
+}
+
+//------------------------------------------------------------------------------
+//! @brief   Read a block of 32 bit registers, wrapper of tryBlockRead()
+//------------------------------------------------------------------------------
+int32_t VmeMaster::blockRead( AddressSpace space, TransferMode mode,
+                              uint32_t baseAddress, uint32_t subAddress,
+                              uint32_t wordsToRead, uint32_t* buffer ) {
+  Status status = tryBlockRead( space, mode, baseAddress, subAddress, wordsToRead, buffer );
+  if( status ) throwError( status, "read block from", baseAddress + subAddress );
+  return wordsToRead;
+}
+
+//------------------------------------------------------------------------------
+//! @brief   Create a read cycle for a transaction list
+//------------------------------------------------------------------------------
+VmeMaster::Transaction VmeMaster::readCycle( AddressSpace space, DataWidth width, uint32_t address ) {
+  Transaction t = { space, width, false, address, 0 };
+  return t;
+}
+
+//------------------------------------------------------------------------------
+//! @brief   Create a write cycle for a transaction list
+//------------------------------------------------------------------------------
+VmeMaster::Transaction VmeMaster::writeCycle( AddressSpace space, DataWidth width, uint32_t address, uint32_t value ) {
+  Transaction t = { space, width, true, address, value };
+  return t;
+}
+
+//------------------------------------------------------------------------------
+//! @brief   Execute a list of single cycles with the single cycle accessors
+//------------------------------------------------------------------------------
+VmeMaster::Status VmeMaster::tryExecute( TransactionList& list, size_t& executed ) {
+  executed = 0;
+  if( !isLinkUp() ) return LINK_DOWN;
+  LinkGuard guard( *this );
+  for( ; executed < list.size(); ++executed ) {
+    Transaction& t = list[executed];
+    Status status = t.write ? tryWrite( t.space, t.width, t.address, t.value )
+                            : tryRead( t.space, t.width, t.address, t.value );
+    if( status ) return status;
+  }
+  return SUCCESS;
+}
+
+//------------------------------------------------------------------------------
+//! @brief   Execute a list of single cycles, wrapper of tryExecute()
+//------------------------------------------------------------------------------
+size_t VmeMaster::execute( TransactionList& list ) {
+  size_t executed = 0;
+  Status status = tryExecute( list, executed );
+  if( status ) {
+    char operation[64];
+    sprintf( operation, "execute transaction %lu of %lu on",
+             (unsigned long)executed + 1, (unsigned long)list.size() );
+    throwError( status, operation, list[executed].address );
+  }
+  return list.size();
+}
+
+//------------------------------------------------------------------------------
+//! @brief   VME interrupts are not supported by default
+//------------------------------------------------------------------------------
+bool VmeMaster::irqSupported() const {
+  return false;
+}
+
+//------------------------------------------------------------------------------
+//! @brief   VME interrupts are not supported by default
+//------------------------------------------------------------------------------
+VmeMaster::Status VmeMaster::tryWaitForIrq( int level, double timeout, uint32_t* vector, bool& received ) {
+  received = false;
+  return SUCCESS;
+}
+
+//------------------------------------------------------------------------------
+//! @brief   Wait for a VME interrupt, wrapper of tryWaitForIrq()
+//------------------------------------------------------------------------------
+bool VmeMaster::waitForIrq( int level, double timeout, uint32_t* vector ) {
+  bool received = false;
+  Status status = tryWaitForIrq( level, timeout, vector, received );
+  if( status ) {
+    char errmsg[255];
+    int error = _lastError;
+    if( BUS_ERROR == status && error )
+      sprintf( errmsg, "Waiting for VME IRQ %d failed: %s(%d)", level, strerror( error ), error );
+    else
+      sprintf( errmsg, "Waiting for VME IRQ %d failed: %s", level, statusString( status ) );
+    throw VmeException( errmsg );
+  }
+  return received;
+}
+
+//------------------------------------------------------------------------------
+//! @brief   Mapped access is not supported by default
+//------------------------------------------------------------------------------
+bool VmeMaster::mapWindow( AddressSpace space, uint32_t baseAddress, uint32_t size ) {
+  return false;
+}
+
+// Configuration routines. Called directly, or from the iocsh function below
+extern "C" {
+
+  //----------------------------------------------------------------------------
+  //! @brief   EPICS iocsh callable function to print the statistics of all
+  //!          VME masters
+  //!
+  //! @param  [in]  level  level of detail
+  //----------------------------------------------------------------------------
+  int vmeMasterReport( const int level ) {
+    if( !VmeMaster::exists() ) {
+      fprintf( stderr, "vmeMasterReport: No VME master configured\n" );
+      return -1;
+    }
+    VmeMaster::reportAll( stdout, level );
+    return 0;
+  }
+  static const iocshArg vmeMasterReportArg0 = { "level", iocshArgInt };
+  static const iocshArg * const vmeMasterReportArgs[] = { &vmeMasterReportArg0 };
+  static const iocshFuncDef vmeMasterReportFuncDef = { "vmeMasterReport", 1, vmeMasterReportArgs };
+  static void vmeMasterReportCallFunc( const iocshArgBuf *args ) {
+    vmeMasterReport( args[0].ival );
+  }
+
+  //----------------------------------------------------------------------------
+  //! @brief   EPICS iocsh callable function to bring a VME link up again
+  //!          after it has been marked down
+  //!
+  //! @param  [in]  name  name of the link (empty: default link)
+  //----------------------------------------------------------------------------
+  int vmeMasterReconnect( const char *name ) {
+    VmeMaster *vme = VmeMaster::getInstance( name );
+    if( !vme ) return -1;
+    if( !vme->reconnect() ) {
+      fprintf( stderr, "vmeMasterReconnect: Reconnect failed\n" );
+      return -1;
+    }
+    return 0;
+  }
+  static const iocshArg vmeMasterReconnectArg0 = { "name", iocshArgString };
+  static const iocshArg * const vmeMasterReconnectArgs[] = { &vmeMasterReconnectArg0 };
+  static const iocshFuncDef vmeMasterReconnectFuncDef = { "vmeMasterReconnect", 1, vmeMasterReconnectArgs };
+  static void vmeMasterReconnectCallFunc( const iocshArgBuf *args ) {
+    vmeMasterReconnect( args[0].sval );
+  }
+
+  //----------------------------------------------------------------------------
+  //! @brief   Register functions to EPICS
+  //----------------------------------------------------------------------------
+  void VmeMasterRegister( void ) {
+    static int firstTime = 1;
+    if ( firstTime ) {
+      iocshRegister( &vmeMasterReportFuncDef, vmeMasterReportCallFunc );
+      iocshRegister( &vmeMasterReconnectFuncDef, vmeMasterReconnectCallFunc );
+      firstTime = 0;
+    }
+  }
+
+  epicsExportRegistrar( VmeMasterRegister );
+}
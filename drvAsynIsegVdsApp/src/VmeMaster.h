@@ -30,7 +30,13 @@
 #include <cctype>
 #include <cstdio>
 #include <stdint.h>
+#include <map>
 #include <string>
+#include <vector>
+
+#include <epicsMutex.h>
+
+#include "LatencyHistogram.h"
 
 //_____ D E F I N I T I O N S __________________________________________________
 
@@ -40,8 +46,94 @@
 //! VME master.
 class VmeMaster {
  public: 
+  //! VME address spaces
+  enum AddressSpace {
+    A16,  //!< short I/O space
+    A24,  //!< standard space
+    A32   //!< extended space
+  };
+
+  //! VME data transfer modes used for block reads
+  enum TransferMode {
+    D32,     //!< single 32 bit cycles
+    BLT32,   //!< 32 bit block transfer
+    MBLT64   //!< 64 bit multiplexed block transfer
+  };
+
+  //! Data width of a single cycle, the value is the number of bytes
+  enum DataWidth {
+    WIDTH8  = 1,  //!< D8 cycle
+    WIDTH16 = 2,  //!< D16 cycle
+    WIDTH32 = 4   //!< D32 cycle
+  };
+
+  //! Result of the accessors not throwing exceptions
+  enum Status {
+    SUCCESS = 0,    //!< transfer done
+    BUS_ERROR,      //!< transfer failed on the VMEbus or in the VME master
+    LINK_DOWN,      //!< link is down, the VME master has not been accessed
+    NOT_SUPPORTED   //!< address space or data width not supported by the VME master
+  };
+
+  //! One single cycle of a transaction list
+  typedef struct {
+    AddressSpace space;    //!< address space
+    DataWidth    width;    //!< data width
+    bool         write;    //!< true: write cycle, false: read cycle
+    uint32_t     address;  //!< VME address (base address + sub address)
+    uint32_t     value;    //!< value to write, receives the data of a read cycle
+  } Transaction;
+
+  //! List of single cycles executed by one call of execute()
+  typedef std::vector<Transaction> TransactionList;
+
+  static Transaction readCycle( AddressSpace space, DataWidth width, uint32_t address );
+  static Transaction writeCycle( AddressSpace space, DataWidth width, uint32_t address, uint32_t value );
+  static const char* statusString( Status status );
+
+  //! Statistics of a VME link
+  typedef struct {
+    unsigned long cycles;       //!< number of single cycles and block transfers
+    unsigned long bytes;        //!< number of bytes transferred
+    unsigned long errors;       //!< number of failed transfers
+    unsigned long contentions;  //!< number of accesses which had to wait for the link
+    unsigned long linkDowns;    //!< number of times the link went down
+  } Statistics;
+
   static VmeMaster* getInstance(); 
+  static VmeMaster* getInstance( const char* name );
   static bool exists();
+  static bool exists( const char* name );
+  static void reportAll( FILE *fp, int details );
+
+  Statistics getStatistics() const;
+  void resetStatistics();
+  virtual void report( FILE *fp, int details );
+
+  bool isLinkUp() const;
+  void setLinkDown();
+  int  lastError() const;
+  virtual bool reconnect();
+
+  //! @brief     Single read cycle without exceptions
+  //!
+  //! Returns LINK_DOWN without accessing the VME master while the link is
+  //! down, this is the access path to use for periodic traffic.
+  //!
+  //! @param     [in]  space    address space
+  //! @param     [in]  width    data width
+  //! @param     [in]  address  VME address (base address + sub address)
+  //! @param     [out] value    data read, not changed if the cycle failed
+  //! @return    SUCCESS or the reason of the failure, see lastError()
+  virtual Status   tryRead ( AddressSpace space, DataWidth width, uint32_t address, uint32_t& value ) = 0;
+
+  //! @brief     Single write cycle without exceptions
+  //! @param     [in]  space    address space
+  //! @param     [in]  width    data width
+  //! @param     [in]  address  VME address (base address + sub address)
+  //! @param     [in]  value    value to write
+  //! @return    SUCCESS or the reason of the failure, see lastError()
+  virtual Status   tryWrite( AddressSpace space, DataWidth width, uint32_t address, uint32_t value ) = 0;
 
   //! @{
   //! @brief     Write VME registers with 16 bit address length
@@ -49,9 +141,12 @@ class VmeMaster {
   //! @param     [in]  subAddress   address of register relative to base address
   //! @param     [in]  value        value to write
   //! @exception VmeException       Exception holding error message if write cmd failed
-  virtual void     writeRegisterA16D8  ( uint32_t baseAddress, uint32_t subAddress, uint8_t  value ) = 0;
-  virtual void     writeRegisterA16D16 ( uint32_t baseAddress, uint32_t subAddress, uint16_t value ) = 0;
-  virtual void     writeRegisterA16D32 ( uint32_t baseAddress, uint32_t subAddress, uint32_t value ) = 0;
+  //!
+  //! The accessors of this and the following groups are wrappers of
+  //! tryRead() and tryWrite().
+  virtual void     writeRegisterA16D8  ( uint32_t baseAddress, uint32_t subAddress, uint8_t  value );
+  virtual void     writeRegisterA16D16 ( uint32_t baseAddress, uint32_t subAddress, uint16_t value );
+  virtual void     writeRegisterA16D32 ( uint32_t baseAddress, uint32_t subAddress, uint32_t value );
   //! @}
 
   //! @{
@@ -60,9 +155,9 @@ class VmeMaster {
   //! @param     [in]  subAddress   address of register relative to base address
   //! @return    data read from register
   //! @exception VmeException       Exception holding error message if read cmd failed
-  virtual uint8_t  readRegisterA16D8   ( uint32_t baseAddress, uint32_t subAddress ) = 0;
-  virtual uint16_t readRegisterA16D16  ( uint32_t baseAddress, uint32_t subAddress ) = 0;
-  virtual uint32_t readRegisterA16D32  ( uint32_t baseAddress, uint32_t subAddress ) = 0;
+  virtual uint8_t  readRegisterA16D8   ( uint32_t baseAddress, uint32_t subAddress );
+  virtual uint16_t readRegisterA16D16  ( uint32_t baseAddress, uint32_t subAddress );
+  virtual uint32_t readRegisterA16D32  ( uint32_t baseAddress, uint32_t subAddress );
   //! @}
 
   //! @{
@@ -71,9 +166,9 @@ class VmeMaster {
   //! @param     [in]  subAddress   address of register relative to base address
   //! @param     [in]  value        value to write
   //! @exception VmeException       Exception holding error message if read cmd failed
-  virtual void     writeRegisterA24D8  ( uint32_t baseAddress, uint32_t subAddress, uint8_t  value ) = 0;
-  virtual void     writeRegisterA24D16 ( uint32_t baseAddress, uint32_t subAddress, uint16_t value ) = 0;
-  virtual void     writeRegisterA24D32 ( uint32_t baseAddress, uint32_t subAddress, uint32_t value ) = 0;
+  virtual void     writeRegisterA24D8  ( uint32_t baseAddress, uint32_t subAddress, uint8_t  value );
+  virtual void     writeRegisterA24D16 ( uint32_t baseAddress, uint32_t subAddress, uint16_t value );
+  virtual void     writeRegisterA24D32 ( uint32_t baseAddress, uint32_t subAddress, uint32_t value );
   //! @}
 
   //! @{
@@ -82,9 +177,9 @@ class VmeMaster {
   //! @param     [in]  subAddress   address of register relative to base address
   //! @return    data read from register
   //! @exception VmeException       Exception holding error message if read cmd failed
-  virtual uint8_t  readRegisterA24D8   ( uint32_t baseAddress, uint32_t subAddress ) = 0;
-  virtual uint16_t readRegisterA24D16  ( uint32_t baseAddress, uint32_t subAddress ) = 0;
-  virtual uint32_t readRegisterA24D32  ( uint32_t baseAddress, uint32_t subAddress ) = 0;
+  virtual uint8_t  readRegisterA24D8   ( uint32_t baseAddress, uint32_t subAddress );
+  virtual uint16_t readRegisterA24D16  ( uint32_t baseAddress, uint32_t subAddress );
+  virtual uint32_t readRegisterA24D32  ( uint32_t baseAddress, uint32_t subAddress );
   //! @}
 
   //! @{
@@ -93,9 +188,9 @@ class VmeMaster {
   //! @param     [in]  subAddress   address of register relative to base address
   //! @param     [in]  value        value to write
   //! @exception VmeException       Exception holding error message if read cmd failed
-  virtual void     writeRegisterA32D8  ( uint32_t baseAddress, uint32_t subAddress, uint8_t  value ) = 0;
-  virtual void     writeRegisterA32D16 ( uint32_t baseAddress, uint32_t subAddress, uint16_t value ) = 0;
-  virtual void     writeRegisterA32D32 ( uint32_t baseAddress, uint32_t subAddress, uint32_t value ) = 0;
+  virtual void     writeRegisterA32D8  ( uint32_t baseAddress, uint32_t subAddress, uint8_t  value );
+  virtual void     writeRegisterA32D16 ( uint32_t baseAddress, uint32_t subAddress, uint16_t value );
+  virtual void     writeRegisterA32D32 ( uint32_t baseAddress, uint32_t subAddress, uint32_t value );
   //! @}
 
   //! @{
@@ -104,9 +199,9 @@ class VmeMaster {
   //! @param     [in]  subAddress   address of register relative to base address
   //! @return    data read from register
   //! @exception VmeException       Exception holding error message if read cmd failed
-  virtual uint8_t  readRegisterA32D8   ( uint32_t baseAddress, uint32_t subAddress ) = 0;
-  virtual uint16_t readRegisterA32D16  ( uint32_t baseAddress, uint32_t subAddress ) = 0;
-  virtual uint32_t readRegisterA32D32  ( uint32_t baseAddress, uint32_t subAddress ) = 0;
+  virtual uint8_t  readRegisterA32D8   ( uint32_t baseAddress, uint32_t subAddress );
+  virtual uint16_t readRegisterA32D16  ( uint32_t baseAddress, uint32_t subAddress );
+  virtual uint32_t readRegisterA32D32  ( uint32_t baseAddress, uint32_t subAddress );
   //! @}
  
   //! @brief  ? 
@@ -126,12 +221,137 @@ class VmeMaster {
   virtual int32_t  bltRead( uint32_t baseAddress, uint32_t subAddress, 
                             uint32_t wordsToRead, uint32_t* buffer ) = 0;
 
+  //! @brief     Read a contiguous block of 32 bit registers without exceptions
+  //!
+  //! The default implementation loops over single D32 cycles. VME masters
+  //! supporting block transfers should override this method and fall back
+  //! to it if the requested space or mode is not supported (e.g. A16 which
+  //! has no block transfer address modifiers).
+  //!
+  //! @param     [in]  space        address space of the module
+  //! @param     [in]  mode         preferred transfer mode
+  //! @param     [in]  baseAddress  base address of a VME module
+  //! @param     [in]  subAddress   address of first register relative to base address
+  //! @param     [in]  wordsToRead  number of 32 bit words to read
+  //! @param     [out] buffer       buffer receiving the data
+  //! @return    SUCCESS or the reason of the failure
+  virtual Status   tryBlockRead( AddressSpace space, TransferMode mode,
+                                 uint32_t baseAddress, uint32_t subAddress,
+                                 uint32_t wordsToRead, uint32_t* buffer );
+
+  //! @brief     Read a contiguous block of 32 bit registers
+  //! @return    number of words read
+  //! @exception VmeException       Exception holding error message if read cmd failed
+  int32_t          blockRead( AddressSpace space, TransferMode mode,
+                              uint32_t baseAddress, uint32_t subAddress,
+                              uint32_t wordsToRead, uint32_t* buffer );
+
+  //! @brief     Execute a list of single cycles in the given order without exceptions
+  //!
+  //! The link is locked for the whole list, so the list is not interleaved
+  //! with accesses of other threads. The default implementation calls
+  //! tryRead() and tryWrite(), VME masters should override it to avoid the
+  //! overhead per cycle.
+  //!
+  //! @param     [in,out] list      transactions, read cycles store their data in value
+  //! @param     [out]    executed  number of successful transactions
+  //! @return    SUCCESS or the reason of the failure of transaction executed
+  virtual Status   tryExecute( TransactionList& list, size_t& executed );
+
+  //! @brief     Execute a list of single cycles in the given order
+  //! @param     [in,out] list  transactions, read cycles store their data in value
+  //! @return    number of executed transactions
+  //! @exception VmeException   Exception holding error message if a cycle failed,
+  //!                           the cycles before it have been executed
+  size_t           execute( TransactionList& list );
+
+  //! @brief     Check if the VME master can deliver VME interrupts
+  virtual bool     irqSupported() const;
+
+  //! @brief     Wait for a VME interrupt without exceptions
+  //!
+  //! Has to be called without holding the link lock, other threads keep
+  //! access to the link while waiting. The default implementation returns
+  //! immediately without interrupt, so callers have to check
+  //! irqSupported() first.
+  //!
+  //! @param     [in]  level     VME interrupt level (1 ... 7)
+  //! @param     [in]  timeout   max. time to wait in seconds
+  //! @param     [out] vector    interrupt vector of the IACK cycle
+  //! @param     [out] received  true if an interrupt has been received
+  //! @return    SUCCESS, also if no interrupt arrived, or BUS_ERROR if the
+  //!            interrupt facility failed
+  virtual Status   tryWaitForIrq( int level, double timeout, uint32_t* vector, bool& received );
+
+  //! @brief     Wait for a VME interrupt
+  //! @param     [in]  level    VME interrupt level (1 ... 7)
+  //! @param     [in]  timeout  max. time to wait in seconds
+  //! @param     [out] vector   interrupt vector of the IACK cycle
+  //! @return    true if an interrupt has been received
+  //! @exception VmeException   Exception holding error message if the interrupt
+  //!                           facility failed
+  bool             waitForIrq( int level, double timeout, uint32_t* vector );
+
+  //! @brief     Announce a window which is accessed frequently
+  //!
+  //! VME masters which can map VME space into the process use the mapping
+  //! for single cycles within announced windows, the accessors stay the
+  //! same. The default implementation does not map anything.
+  //!
+  //! @param     [in]  space        address space of the window
+  //! @param     [in]  baseAddress  first VME address of the window
+  //! @param     [in]  size         size of the window in bytes
+  //! @return    true if cycles within the window use the mapping
+  virtual bool     mapWindow( AddressSpace space, uint32_t baseAddress, uint32_t size );
+
  protected:
   VmeMaster();
-  VmeMaster( const VmeMaster& rother );
   virtual ~VmeMaster();
 
-  static VmeMaster* _pinstance;
+  //! @brief   Scoped lock serializing all accesses to one VME link
+  //!
+  //! The link mutex is recursive, so a block transfer holding the lock
+  //! may call the single cycle accessors. An access finding the link
+  //! busy is counted as contention.
+  class LinkGuard {
+   public:
+    LinkGuard( VmeMaster& master );
+    ~LinkGuard();
+   private:
+    LinkGuard( const LinkGuard& );
+    LinkGuard& operator=( const LinkGuard& );
+    VmeMaster& _master;
+  };
+  friend class LinkGuard;
+
+  void countTransfer( unsigned long bytes );
+  void countError( int error = 0 );
+  void keepError( int error );
+  void throwError( Status status, const char* operation, uint32_t address ) const;
+
+  static bool addInstance( const char* name, VmeMaster* instance );
+
+  static const unsigned long linkDownThreshold = 10;  //!< consecutive failures marking the link down
+
+  static VmeMaster* _pinstance;  //!< default link, the first one created
+  static std::map<std::string, VmeMaster*> _instances;  //!< all links by name
+
+ private:
+  VmeMaster( const VmeMaster& );             // not implemented, a link is not copyable
+  VmeMaster& operator=( const VmeMaster& );  // not implemented
+
+  epicsMutex             _linkLock;     //!< serializes accesses to the link
+  LatencyHistogram       _linkWait;     //!< time spent waiting for a busy link, protected by _linkLock
+  // statistics counters, updated atomically after the link lock has been released
+  volatile unsigned long _cycles;
+  volatile unsigned long _bytes;
+  volatile unsigned long _errors;
+  volatile unsigned long _contentions;
+  volatile unsigned long _linkDowns;
+  // link state
+  volatile unsigned long _failures;  //!< consecutive failed transfers
+  volatile int           _linkUp;    //!< 0 if the link has been marked down
+  volatile int           _lastError; //!< errno of the last failed transfer
 
 };
 
@@ -0,0 +1,430 @@
+//******************************************************************************
+// Copyright (C) 2014 Florian Feldbauer <florian@ep1.ruhr-uni-bochum.de>
+//                    - Helmholtz-Institut/University Mainz, Institute for nuclear physics
+//                    Matthias Steinke <matthias@ep1.ruhr-uni-bochum.de>
+//                    - University Bochum, Intitue for experimental physics I
+//
+// This file is part of drvAsynIsegVds
+//
+// drvAsynIsegVds is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// drvAsynIsegVds is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+//
+// version 1.5.0; Sep. 11, 2014
+//******************************************************************************
+
+//_____ I N C L U D E S _______________________________________________________
+
+// ANSI C/C++ includes
+#include <cerrno>
+#include <cstdlib>
+#include <iostream>
+
+// EPICS includes
+#include <epicsExport.h>
+#include <iocsh.h>
+
+// local includes
+#include "VmeMasterMock.h"
+
+//_____ D E F I N I T I O N S __________________________________________________
+
+//_____ G L O B A L S __________________________________________________________
+
+//_____ L O C A L S ____________________________________________________________
+static const uint32_t moduleWindow = 0x0400;  //!< size of the A16 window of one module
+static const uint32_t chanOffset   = 0x0100;  //!< first channel block in the module window
+static const uint32_t chanSize     = 0x0040;  //!< size of a channel block
+static const double   chanLoad     = 1.e9;    //!< simulated load in Ohm
+
+//_____ F U N C T I O N S ______________________________________________________
+
+//------------------------------------------------------------------------------
+VmeMasterMock::VmeMasterMock( double latency, double errorRate )
+  : VmeMaster(),
+    _latency( latency ),
+    _errorRate( errorRate ),
+    _load( chanLoad ),
+    _noise( 0. ),
+    _trips( 0 ),
+    _a16( 0x10000 / 4, 0 )
+{}
+
+//------------------------------------------------------------------------------
+VmeMasterMock::~VmeMasterMock() {}
+
+//------------------------------------------------------------------------------
+//! @brief   Creates an instance of class VmeMasterMock
+//! @param   [in] name       name of the link used by the drivers
+//! @param   [in] latency    duration of each access in seconds
+//! @param   [in] errorRate  fraction of accesses failing with a VmeException
+//------------------------------------------------------------------------------
+void VmeMasterMock::create( const char* name, double latency, double errorRate ) {
+  if ( exists( name ) ) {
+    std::cerr << "VME link " << name << " has already been created" << std::endl;
+    return;
+  }
+  addInstance( name, new VmeMasterMock( latency, errorRate ) );
+}
+
+//------------------------------------------------------------------------------
+//! @brief   Get a simulated link by name
+//! @param   [in] name  name of the link (NULL or empty: default link)
+//! @return  NULL if there is no link with this name or it is not simulated
+//------------------------------------------------------------------------------
+VmeMasterMock* VmeMasterMock::find( const char* name ) {
+  if( !exists( name ) ) return 0;
+  return dynamic_cast<VmeMasterMock*>( getInstance( name ) );
+}
+
+//------------------------------------------------------------------------------
+//! @brief   Restrict the simulated modules to the given base addresses
+//!
+//! Accesses to other module windows fail with a bus error, like an empty
+//! slot of a crate does.
+//!
+//! @param   [in] bases  A16 base addresses of the modules (empty: all windows)
+//------------------------------------------------------------------------------
+void VmeMasterMock::setModules( const std::vector<uint32_t>& bases ) {
+  LinkGuard guard( *this );
+  _populated.clear();
+  if( bases.empty() ) return;
+  _populated.resize( 0x10000 / moduleWindow, false );
+  for( size_t i = 0; i < bases.size(); ++i )
+    _populated[( bases[i] & 0xffff ) / moduleWindow] = true;
+}
+
+//------------------------------------------------------------------------------
+//! @brief   Set the channel load and the measurement noise
+//! @param   [in] load   load of each channel in Ohm, a channel trips if
+//!                      VoltageSet / load exceeds CurrentSet
+//! @param   [in] noise  peak noise of Vmom and Imom as fraction of VMax and IMax
+//------------------------------------------------------------------------------
+void VmeMasterMock::setLoad( double load, double noise ) {
+  LinkGuard guard( *this );
+  _load  = ( load > 0. ) ? load : chanLoad;
+  _noise = ( noise > 0. ) ? noise : 0.;
+}
+
+//------------------------------------------------------------------------------
+//! @brief   Raw content of a float register as float
+//------------------------------------------------------------------------------
+float VmeMasterMock::getFloat( uint32_t address ) const {
+  union { float fval; uint32_t ival; } data;
+  data.ival = _a16[( address & 0xffff ) / 4];
+  return data.fval;
+}
+
+//------------------------------------------------------------------------------
+//! @brief   Store a float in a float register
+//------------------------------------------------------------------------------
+void VmeMasterMock::setFloat( uint32_t address, float value ) {
+  union { float fval; uint32_t ival; } data;
+  data.fval = value;
+  _a16[( address & 0xffff ) / 4] = data.ival;
+}
+
+//------------------------------------------------------------------------------
+//! @brief   Power-on state of a module window
+//------------------------------------------------------------------------------
+void VmeMasterMock::initModule( uint32_t module ) {
+  _a16[module / 4] = 0x7400;  // safety loop closed, module good, supply good, temperature good
+  setFloat( module + 0x0020, 10.f );    // voltage ramp speed in % of VMax per second
+  setFloat( module + 0x0024, 10.f );    // current ramp speed in % of IMax per second
+  setFloat( module + 0x0028, 3000.f );  // VMax
+  setFloat( module + 0x002c, 5.e-4f );  // IMax
+  setFloat( module + 0x0040, 5.01f );
+  setFloat( module + 0x0044, 12.02f );
+  setFloat( module + 0x0048, -11.98f );
+  setFloat( module + 0x004c, 35.5f );
+  for( uint32_t ch = 0; ch < 8; ++ch )
+    setFloat( module + chanOffset + ch * chanSize + 0x0014, 1.e-4f );  // Iset
+}
+
+//------------------------------------------------------------------------------
+//! @brief   Advance the channels of a module window to the current time
+//!
+//! A channel with setON (ChannelControl B3) ramps towards VoltageSet, a
+//! channel switched off ramps down to 0. The end of a ramp sets
+//! ChannelEventStatus B4 and the channel bit of ModuleEventChannelStatus.
+//! If the current exceeds CurrentSet the channel trips: the output drops
+//! to 0, setON is cleared and ChannelStatus/ChannelEventStatus B13 and the
+//! channel bit of ModuleEventChannelStatus are set. Switching the channel
+//! on again clears the trip.
+//------------------------------------------------------------------------------
+void VmeMasterMock::simulate( uint32_t module ) {
+  epicsTimeStamp now;
+  epicsTimeGetCurrent( &now );
+
+  std::map<uint32_t, epicsTimeStamp>::iterator it = _lastUpdate.find( module );
+  if( it == _lastUpdate.end() ) {
+    initModule( module );
+    _lastUpdate[module] = now;
+    return;
+  }
+  double dt = epicsTimeDiffInSeconds( &now, &it->second );
+  it->second = now;
+
+  double vmax = getFloat( module + 0x0028 );
+  double imax = getFloat( module + 0x002c );
+  double rate = getFloat( module + 0x0020 ) / 100. * vmax;
+  bool moduleRamping = false;
+  for( uint32_t ch = 0; ch < 8; ++ch ) {
+    uint32_t chan = module + chanOffset + ch * chanSize;
+    uint32_t& control = _a16[( chan + 0x000c ) / 4];
+    bool on      = ( control & 0x0008 );
+    bool tripped = ( _a16[chan / 4] & 0x2000 ) && !on;
+    double target   = on ? getFloat( chan + 0x0010 ) : 0.;
+    double& voltage = _voltage[chan];
+    double step     = rate * dt;
+    bool wasRamping = ( _a16[chan / 4] & 0x0010 );
+
+    if( voltage < target - step )      voltage += step;
+    else if( voltage > target + step ) voltage -= step;
+    else                               voltage = target;
+    bool ramping = ( voltage != target );
+
+    double current = voltage / _load;
+    if( on && current > getFloat( chan + 0x0014 ) ) {
+      voltage = current = 0.;
+      control &= ~0x0008;
+      on = ramping = false;
+      tripped = true;
+      _a16[( chan + 0x0004 ) / 4]   |= 0x2000;  // trip event
+      _a16[( module + 0x0010 ) / 4] |= ( 1 << ch );
+      ++_trips;
+    }
+
+    double vmom = voltage, imom = current;
+    if( _noise > 0. ) {
+      vmom += _noise * vmax * ( 2. * rand() / RAND_MAX - 1. );
+      imom += _noise * imax * ( 2. * rand() / RAND_MAX - 1. );
+    }
+    setFloat( chan + 0x0018, vmom );
+    setFloat( chan + 0x001c, imom );
+    _a16[chan / 4] = ( on ? 0x0008 : 0 ) | ( ramping ? 0x0010 : 0 ) | ( tripped ? 0x2000 : 0 );
+    if( wasRamping && !ramping && !tripped ) {
+      _a16[( chan + 0x0004 ) / 4]   |= 0x0010;  // end of ramp
+      _a16[( module + 0x0010 ) / 4] |= ( 1 << ch );
+    }
+    moduleRamping |= ramping;
+  }
+
+  if( moduleRamping ) _a16[module / 4] |= 0x0200;
+  else                _a16[module / 4] &= ~0x0200;
+}
+
+//------------------------------------------------------------------------------
+//! @brief   Simulated single cycle
+//!
+//! Writes to the event status registers reset the bits written as 1.
+//!
+//! @param   [in]     space    address space
+//! @param   [in]     address  VME address
+//! @param   [in]     width    data width in bytes
+//! @param   [in]     write    true for write cycles
+//! @param   [in,out] value    value to write, data of a read cycle
+//! @return  BUS_ERROR for injected errors and module windows not populated,
+//!          NOT_SUPPORTED for A24 and A32
+//------------------------------------------------------------------------------
+VmeMaster::Status VmeMasterMock::access( AddressSpace space, uint32_t address, int width, bool write, uint32_t& value ) {
+  if( !isLinkUp() ) return LINK_DOWN;
+  LinkGuard guard( *this );
+
+  if( _latency > 0. ) {
+    epicsTimeStamp start, now;
+    epicsTimeGetCurrent( &start );
+    do {
+      epicsTimeGetCurrent( &now );
+    } while( epicsTimeDiffInSeconds( &now, &start ) < _latency );
+  }
+
+  if( A16 != space ) return NOT_SUPPORTED;
+  if( _errorRate > 0. && rand() < _errorRate * RAND_MAX ) {
+    countError( EIO );
+    return BUS_ERROR;
+  }
+
+  address &= 0xffff;
+  const uint32_t module = address - address % moduleWindow;
+  const uint32_t offset = address % moduleWindow;
+  if( !_populated.empty() && !_populated[module / moduleWindow] ) {
+    countError( EIO );
+    return BUS_ERROR;
+  }
+  simulate( module );
+
+  uint32_t& word = _a16[address / 4];
+  const int shift = ( 4 == width ) ? 0 : 8 * ( 4 - width - ( address & 3 ) );  // big endian byte lanes
+  const uint32_t mask = ( 4 == width ) ? 0xffffffff : ( ( 1u << ( 8 * width ) ) - 1 ) << shift;
+
+  bool eventStatus = ( 0x0004 == offset || 0x0010 == offset ||
+                       ( offset >= chanOffset && offset < chanOffset + 8 * chanSize &&
+                         0x0004 == ( offset - chanOffset ) % chanSize ) );
+  if( write ) {
+    if( eventStatus ) word &= ~( ( value << shift ) & mask );
+    else              word  = ( word & ~mask ) | ( ( value << shift ) & mask );
+  } else {
+    value = ( word & mask ) >> shift;
+  }
+
+  countTransfer( width );
+  return SUCCESS;
+}
+
+//------------------------------------------------------------------------------
+
+VmeMaster::Status VmeMasterMock::tryRead( AddressSpace space, DataWidth width, uint32_t address, uint32_t& value ) {
+  return access( space, address, width, false, value );
+}
+VmeMaster::Status VmeMasterMock::tryWrite( AddressSpace space, DataWidth width, uint32_t address, uint32_t value ) {
+  return access( space, address, width, true, value );
+}
+
+//------------------------------------------------------------------------------
+//! @brief   A32 is not simulated
+//------------------------------------------------------------------------------
+int32_t VmeMasterMock::fifoBltRead( uint32_t baseAddress, uint32_t subAddress, 
+                                    uint32_t wordsToRead, uint32_t* buffer ) {
+  return blockRead( A32, BLT32, baseAddress, subAddress, wordsToRead, buffer );
+}
+
+//------------------------------------------------------------------------------
+//! @brief   A32 is not simulated
+//------------------------------------------------------------------------------
+int32_t VmeMasterMock::bltRead( uint32_t baseAddress, uint32_t subAddress, 
+                                uint32_t wordsToRead, uint32_t* buffer ) {
+  return blockRead( A32, BLT32, baseAddress, subAddress, wordsToRead, buffer );
+}
+
+//------------------------------------------------------------------------------
+//! @brief   Print configuration and statistics of the simulated link
+//------------------------------------------------------------------------------
+void VmeMasterMock::report( FILE *fp, int details ) {
+  unsigned long modules = 0;
+  for( size_t i = 0; i < _populated.size(); ++i ) modules += _populated[i];
+  fprintf( fp, "Simulated VME master: latency %g us, error rate %g\n", _latency * 1.e6, _errorRate );
+  if( _populated.empty() )
+    fprintf( fp, "  all module windows, load %g Ohm, noise %g, %lu trips\n", _load, _noise, _trips );
+  else
+    fprintf( fp, "  %lu modules, load %g Ohm, noise %g, %lu trips\n", modules, _load, _noise, _trips );
+  VmeMaster::report( fp, details );
+}
+
+// Configuration routines. Called directly, or from the iocsh function below
+extern "C" {
+  
+  //----------------------------------------------------------------------------
+  //! @brief   EPICS iocsh callable function to call constructor
+  //!          for the VmeMasterMock class.
+  //!
+  //! @param  [in]  name       The name of the link (e.g. "sim")
+  //! @param  [in]  latency    Duration of each access in microseconds
+  //! @param  [in]  errorRate  Fraction of accesses failing with a bus error
+  //----------------------------------------------------------------------------
+  int vmeMockConfigure( const char *name, const double latency, const double errorRate ) {
+    if( !name || !name[0] ) {
+      fprintf( stderr, "vmeMockConfigure: No link name given\n" );
+      return -1;
+    }
+    VmeMasterMock::create( name, latency * 1.e-6, errorRate );
+    return 0;
+  }
+  static const iocshArg initMockArg0 = { "name",      iocshArgString };
+  static const iocshArg initMockArg1 = { "latency",   iocshArgDouble };
+  static const iocshArg initMockArg2 = { "errorRate", iocshArgDouble };
+  static const iocshArg * const initMockArgs[] = { &initMockArg0, &initMockArg1, &initMockArg2 };
+  static const iocshFuncDef initMockFuncDef = { "vmeMockConfigure", 3, initMockArgs };
+  static void initMockCallFunc( const iocshArgBuf *args ) {
+    vmeMockConfigure( args[0].sval, args[1].dval, args[2].dval );
+  }
+
+  //----------------------------------------------------------------------------
+  //! @brief   EPICS iocsh callable function to set the populated module
+  //!          windows of a simulated link
+  //!
+  //! @param  [in]  name           The name of the simulated link
+  //! @param  [in]  baseAddresses  Base addresses of the modules, separated by
+  //!                              comma or blanks (e.g. "0x4000,0x4400")
+  //----------------------------------------------------------------------------
+  int vmeMockSetModules( const char *name, const char *baseAddresses ) {
+    VmeMasterMock* mock = VmeMasterMock::find( name );
+    if( !mock ) {
+      fprintf( stderr, "vmeMockSetModules: No simulated link '%s'\n", name ? name : "" );
+      return -1;
+    }
+    std::vector<uint32_t> bases;
+    const char *pos = baseAddresses;
+    while( pos && *pos ) {
+      if( ',' == *pos || isspace( (unsigned char)*pos ) ) { ++pos; continue; }
+      char *end = 0;
+      unsigned long BA = strtoul( pos, &end, 0 );
+      if( end == pos || BA > 0xffff ) {
+        fprintf( stderr, "vmeMockSetModules: Invalid base address in '%s'\n", baseAddresses );
+        return -1;
+      }
+      bases.push_back( BA );
+      pos = end;
+    }
+    mock->setModules( bases );
+    return 0;
+  }
+  static const iocshArg setModulesArg0 = { "name",          iocshArgString };
+  static const iocshArg setModulesArg1 = { "baseAddresses", iocshArgString };
+  static const iocshArg * const setModulesArgs[] = { &setModulesArg0, &setModulesArg1 };
+  static const iocshFuncDef setModulesFuncDef = { "vmeMockSetModules", 2, setModulesArgs };
+  static void setModulesCallFunc( const iocshArgBuf *args ) {
+    vmeMockSetModules( args[0].sval, args[1].sval );
+  }
+
+  //----------------------------------------------------------------------------
+  //! @brief   EPICS iocsh callable function to set the channel load and
+  //!          the measurement noise of a simulated link
+  //!
+  //! @param  [in]  name   The name of the simulated link
+  //! @param  [in]  load   Load of each channel in Ohm (0: 1 GOhm)
+  //! @param  [in]  noise  Peak noise of Vmom/Imom as fraction of VMax/IMax
+  //----------------------------------------------------------------------------
+  int vmeMockSetLoad( const char *name, const double load, const double noise ) {
+    VmeMasterMock* mock = VmeMasterMock::find( name );
+    if( !mock ) {
+      fprintf( stderr, "vmeMockSetLoad: No simulated link '%s'\n", name ? name : "" );
+      return -1;
+    }
+    mock->setLoad( load, noise );
+    return 0;
+  }
+  static const iocshArg setLoadArg0 = { "name",  iocshArgString };
+  static const iocshArg setLoadArg1 = { "load",  iocshArgDouble };
+  static const iocshArg setLoadArg2 = { "noise", iocshArgDouble };
+  static const iocshArg * const setLoadArgs[] = { &setLoadArg0, &setLoadArg1, &setLoadArg2 };
+  static const iocshFuncDef setLoadFuncDef = { "vmeMockSetLoad", 3, setLoadArgs };
+  static void setLoadCallFunc( const iocshArgBuf *args ) {
+    vmeMockSetLoad( args[0].sval, args[1].dval, args[2].dval );
+  }
+  
+  //----------------------------------------------------------------------------
+  //! @brief   Register functions to EPICS
+  //----------------------------------------------------------------------------
+  void VmeMasterMockRegister( void ) {
+    static int firstTime = 1;
+    if ( firstTime ) {
+      iocshRegister( &initMockFuncDef, initMockCallFunc );
+      iocshRegister( &setModulesFuncDef, setModulesCallFunc );
+      iocshRegister( &setLoadFuncDef, setLoadCallFunc );
+      firstTime = 0;
+    }
+  }
+  
+  epicsExportRegistrar( VmeMasterMockRegister );
+}
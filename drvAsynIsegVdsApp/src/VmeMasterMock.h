@@ -0,0 +1,92 @@
+//******************************************************************************
+// Copyright (C) 2014 Florian Feldbauer <florian@ep1.ruhr-uni-bochum.de>
+//                    - Helmholtz-Institut/University Mainz, Institute for nuclear physics
+//                    Matthias Steinke <matthias@ep1.ruhr-uni-bochum.de>
+//                    - University Bochum, Intitue for experimental physics I
+//
+// This file is part of drvAsynIsegVds
+//
+// drvAsynIsegVds is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// drvAsynIsegVds is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+//
+// version 1.5.0; Sep. 11, 2014
+//******************************************************************************
+
+#pragma once
+
+//_____ I N C L U D E S _______________________________________________________
+#include <cctype>
+#include <cstdio>
+#include <stdint.h>
+#include <map>
+#include <vector>
+
+#include <epicsTime.h>
+
+#include "VmeMaster.h"
+
+//_____ D E F I N I T I O N S __________________________________________________
+
+//! @brief   Simulated VME master with VDS modules
+//!
+//! This class simulates the A16 register map of ISEG VDS modules without
+//! hardware. Every 1 kB window of the A16 space behaves like a VDS module
+//! (module registers at 0x000, channel i at 0x100 + 0x40 * i), unless
+//! the populated windows have been restricted by setModules(). Channels
+//! which are switched on ramp with the module ramp speed towards their
+//! voltage setpoint, the load (default 1 GOhm) gives the current. A channel
+//! exceeding its current setpoint trips: it is switched off and shows
+//! ChannelStatus B13 until it is switched on again. A24 and A32 are not
+//! simulated. The latency of each access, a rate of failing accesses and
+//! the noise of the measurements can be configured.
+class VmeMasterMock : public VmeMaster {
+ public: 
+  static void create( const char* name, double latency, double errorRate );
+  static VmeMasterMock* find( const char* name );
+
+  void     setModules( const std::vector<uint32_t>& bases );
+  void     setLoad( double load, double noise );
+
+  Status   tryRead ( AddressSpace, DataWidth, uint32_t, uint32_t& );
+  Status   tryWrite( AddressSpace, DataWidth, uint32_t, uint32_t );
+
+  int32_t  fifoBltRead( uint32_t, uint32_t, uint32_t, uint32_t* );
+  int32_t  bltRead( uint32_t, uint32_t, uint32_t, uint32_t* );
+
+  void     report( FILE *fp, int details );
+
+ private:
+  VmeMasterMock( double latency, double errorRate );
+  VmeMasterMock( const VmeMasterMock& );             // not implemented, the link is not copyable
+  VmeMasterMock& operator=( const VmeMasterMock& );  // not implemented
+  virtual ~VmeMasterMock();
+
+  Status   access( AddressSpace space, uint32_t address, int width, bool write, uint32_t& value );
+  void     initModule( uint32_t module );
+  void     simulate( uint32_t module );
+  float    getFloat( uint32_t address ) const;
+  void     setFloat( uint32_t address, float value );
+
+  double   _latency;    //!< duration of each access in seconds
+  double   _errorRate;  //!< fraction of failing accesses
+  double   _load;       //!< load of each channel in Ohm
+  double   _noise;      //!< noise of Vmom and Imom as fraction of VMax and IMax
+  unsigned long _trips; //!< number of simulated trips
+
+  std::vector<uint32_t>              _a16;         //!< A16 register contents
+  std::vector<bool>                  _populated;   //!< module windows answering, empty: all
+  std::map<uint32_t, double>         _voltage;     //!< true output voltage by channel block
+  std::map<uint32_t, epicsTimeStamp> _lastUpdate;  //!< time of last simulation step by module window
+
+};
@@ -0,0 +1,309 @@
+//******************************************************************************
+// Copyright (C) 2014 Florian Feldbauer <florian@ep1.ruhr-uni-bochum.de>
+//                    - Helmholtz-Institut/University Mainz, Institute for nuclear physics
+//                    Matthias Steinke <matthias@ep1.ruhr-uni-bochum.de>
+//                    - University Bochum, Intitue for experimental physics I
+//
+// This file is part of drvAsynIsegVds
+//
+// drvAsynIsegVds is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// drvAsynIsegVds is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+//
+// version 1.5.0; Sep. 11, 2014
+//******************************************************************************
+
+//_____ I N C L U D E S _______________________________________________________
+
+// ANSI C/C++ includes
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+
+// EPICS includes
+#include <epicsExit.h>
+#include <epicsExport.h>
+#include <iocsh.h>
+
+// local includes
+#include "VmeMasterRecorder.h"
+
+//_____ D E F I N I T I O N S __________________________________________________
+
+//_____ G L O B A L S __________________________________________________________
+
+//_____ L O C A L S ____________________________________________________________
+
+//------------------------------------------------------------------------------
+//! @brief   Address space as recorded in the file
+//------------------------------------------------------------------------------
+static int spaceBits( VmeMaster::AddressSpace space ) {
+  switch( space ) {
+    case VmeMaster::A16: return 16;
+    case VmeMaster::A24: return 24;
+    case VmeMaster::A32: return 32;
+  }
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+//! @brief   Flush the recording at exit of the IOC
+//------------------------------------------------------------------------------
+static void flushC( void* pvt ) {
+  VmeMasterRecorder* pRecorder = (VmeMasterRecorder*)pvt;
+  pRecorder->flush();
+}
+
+//_____ F U N C T I O N S ______________________________________________________
+
+//------------------------------------------------------------------------------
+VmeMasterRecorder::VmeMasterRecorder( VmeMaster* link, FILE* file )
+  : VmeMaster(),
+    _link( link ),
+    _file( file ),
+    _lines( 0 )
+{
+  epicsTimeGetCurrent( &_start );
+}
+
+//------------------------------------------------------------------------------
+VmeMasterRecorder::~VmeMasterRecorder() {}
+
+//------------------------------------------------------------------------------
+//! @brief   Creates an instance of class VmeMasterRecorder
+//! @param   [in] name  name of the link used by the drivers
+//! @param   [in] link  name of the recorded link (empty: default link)
+//! @param   [in] file  name of the file receiving the recording
+//------------------------------------------------------------------------------
+void VmeMasterRecorder::create( const char* name, const char* link, const char* file ) {
+  if ( exists( name ) ) {
+    std::cerr << "VME link " << name << " has already been created" << std::endl;
+    return;
+  }
+  VmeMaster* recorded = getInstance( link );
+  if( !recorded ) return;
+
+  FILE* fp = fopen( file, "w" );
+  if( !fp ) {
+    std::cerr << "Could not open " << file << ": " << strerror( errno ) << std::endl;
+    return;
+  }
+  setvbuf( fp, NULL, _IOFBF, 0x10000 );
+  VmeMasterRecorder* recorder = new VmeMasterRecorder( recorded, fp );
+  addInstance( name, recorder );
+  epicsAtExit( flushC, recorder );
+}
+
+//------------------------------------------------------------------------------
+//! @brief   Count an access in the statistics of this link
+//!
+//! The failures of the recorded link also mark this link down, reconnect()
+//! brings both up again.
+//------------------------------------------------------------------------------
+void VmeMasterRecorder::count( Status status, unsigned long bytes ) {
+  if( SUCCESS == status ) countTransfer( bytes );
+  else                    countError( _link->lastError() );
+}
+
+//------------------------------------------------------------------------------
+//! @brief   Write the line of a single cycle
+//!
+//! Called with this link locked, so the lines are in the order of the
+//! accesses.
+//------------------------------------------------------------------------------
+void VmeMasterRecorder::record( char type, AddressSpace space, DataWidth width, uint32_t address,
+                                uint32_t value, Status status ) {
+  epicsTimeStamp now;
+  epicsTimeGetCurrent( &now );
+  _fileLock.lock();
+  fprintf( _file, "%.6f %c %d %d %08x %08x %d\n", epicsTimeDiffInSeconds( &now, &_start ), type,
+           spaceBits( space ), (int)width, address, value, (int)status );
+  ++_lines;
+  _fileLock.unlock();
+}
+
+//------------------------------------------------------------------------------
+//! @brief   Write the buffered lines to the file
+//------------------------------------------------------------------------------
+void VmeMasterRecorder::flush() {
+  _fileLock.lock();
+  fflush( _file );
+  _fileLock.unlock();
+}
+
+//------------------------------------------------------------------------------
+
+VmeMaster::Status VmeMasterRecorder::tryRead( AddressSpace space, DataWidth width, uint32_t address, uint32_t& value ) {
+  if( !isLinkUp() ) return LINK_DOWN;
+  LinkGuard guard( *this );
+  Status status = _link->tryRead( space, width, address, value );
+  count( status, width );
+  record( 'R', space, width, address, status ? 0 : value, status );
+  return status;
+}
+VmeMaster::Status VmeMasterRecorder::tryWrite( AddressSpace space, DataWidth width, uint32_t address, uint32_t value ) {
+  if( !isLinkUp() ) return LINK_DOWN;
+  LinkGuard guard( *this );
+  Status status = _link->tryWrite( space, width, address, value );
+  count( status, width );
+  record( 'W', space, width, address, value, status );
+  return status;
+}
+
+//------------------------------------------------------------------------------
+//! @brief   Block read of the recorded link, written as one B line
+//------------------------------------------------------------------------------
+VmeMaster::Status VmeMasterRecorder::tryBlockRead( AddressSpace space, TransferMode mode,
+                                                   uint32_t baseAddress, uint32_t subAddress,
+                                                   uint32_t wordsToRead, uint32_t* buffer ) {
+  if( !isLinkUp() ) return LINK_DOWN;
+  LinkGuard guard( *this );
+  Status status = _link->tryBlockRead( space, mode, baseAddress, subAddress, wordsToRead, buffer );
+  count( status, 4 * wordsToRead );
+
+  epicsTimeStamp now;
+  epicsTimeGetCurrent( &now );
+  _fileLock.lock();
+  fprintf( _file, "%.6f B %d %08x %u %d", epicsTimeDiffInSeconds( &now, &_start ), spaceBits( space ),
+           baseAddress + subAddress, status ? 0 : wordsToRead, (int)status );
+  for( uint32_t i = 0; !status && i < wordsToRead; ++i )
+    fprintf( _file, " %08x", buffer[i] );
+  fputc( '\n', _file );
+  ++_lines;
+  _fileLock.unlock();
+  return status;
+}
+
+//------------------------------------------------------------------------------
+//! @brief   Transaction list of the recorded link, written as single cycles
+//!
+//! The cycles after a failed cycle have not been executed and are not
+//! recorded.
+//------------------------------------------------------------------------------
+VmeMaster::Status VmeMasterRecorder::tryExecute( TransactionList& list, size_t& executed ) {
+  executed = 0;
+  if( !isLinkUp() ) return LINK_DOWN;
+  LinkGuard guard( *this );
+  Status status = _link->tryExecute( list, executed );
+  for( size_t i = 0; i < executed && i < list.size(); ++i ) {
+    count( SUCCESS, list[i].width );
+    record( list[i].write ? 'W' : 'R', list[i].space, list[i].width, list[i].address, list[i].value, SUCCESS );
+  }
+  if( status && executed < list.size() ) {
+    const Transaction& failed = list[executed];
+    count( status, failed.width );
+    record( failed.write ? 'W' : 'R', failed.space, failed.width, failed.address,
+            failed.write ? failed.value : 0, status );
+  }
+  return status;
+}
+
+//------------------------------------------------------------------------------
+//! @brief   Passed to the recorded link, not recorded
+//------------------------------------------------------------------------------
+int32_t VmeMasterRecorder::fifoBltRead( uint32_t baseAddress, uint32_t subAddress, 
+                                        uint32_t wordsToRead, uint32_t* buffer ) {
+  return _link->fifoBltRead( baseAddress, subAddress, wordsToRead, buffer );
+}
+
+//------------------------------------------------------------------------------
+//! @brief   Passed to the recorded link, not recorded
+//------------------------------------------------------------------------------
+int32_t VmeMasterRecorder::bltRead( uint32_t baseAddress, uint32_t subAddress, 
+                                    uint32_t wordsToRead, uint32_t* buffer ) {
+  return _link->bltRead( baseAddress, subAddress, wordsToRead, buffer );
+}
+
+//------------------------------------------------------------------------------
+//! @brief   Reconnect the recorded link, then this one
+//------------------------------------------------------------------------------
+bool VmeMasterRecorder::reconnect() {
+  if( !_link->isLinkUp() && !_link->reconnect() ) return false;
+  return VmeMaster::reconnect();
+}
+
+//------------------------------------------------------------------------------
+//! @brief   Interrupts of the recorded link, they are not recorded
+//------------------------------------------------------------------------------
+bool VmeMasterRecorder::irqSupported() const {
+  return _link->irqSupported();
+}
+VmeMaster::Status VmeMasterRecorder::tryWaitForIrq( int level, double timeout, uint32_t* vector, bool& received ) {
+  return _link->tryWaitForIrq( level, timeout, vector, received );
+}
+
+//------------------------------------------------------------------------------
+//! @brief   Windows are mapped by the recorded link
+//------------------------------------------------------------------------------
+bool VmeMasterRecorder::mapWindow( AddressSpace space, uint32_t baseAddress, uint32_t size ) {
+  return _link->mapWindow( space, baseAddress, size );
+}
+
+//------------------------------------------------------------------------------
+//! @brief   Print the size of the recording and the statistics of both links
+//------------------------------------------------------------------------------
+void VmeMasterRecorder::report( FILE *fp, int details ) {
+  _fileLock.lock();
+  unsigned long lines = _lines;
+  _fileLock.unlock();
+  fprintf( fp, "Recording VME master: %lu lines\n", lines );
+  VmeMaster::report( fp, details );
+  fprintf( fp, "  recorded link: " );
+  _link->report( fp, details );
+}
+
+// Configuration routines. Called directly, or from the iocsh function below
+extern "C" {
+  
+  //----------------------------------------------------------------------------
+  //! @brief   EPICS iocsh callable function to call constructor
+  //!          for the VmeMasterRecorder class.
+  //!
+  //! @param  [in]  name  The name of the new link (e.g. "rec0")
+  //! @param  [in]  link  The name of the recorded link (empty: default link)
+  //! @param  [in]  file  The file receiving the recording
+  //----------------------------------------------------------------------------
+  int vmeRecordConfigure( const char *name, const char *link, const char *file ) {
+    if( !name || !name[0] ) {
+      fprintf( stderr, "vmeRecordConfigure: No link name given\n" );
+      return -1;
+    }
+    if( !file || !file[0] ) {
+      fprintf( stderr, "vmeRecordConfigure: No file given\n" );
+      return -1;
+    }
+    VmeMasterRecorder::create( name, link, file );
+    return 0;
+  }
+  static const iocshArg initRecordArg0 = { "name", iocshArgString };
+  static const iocshArg initRecordArg1 = { "link", iocshArgString };
+  static const iocshArg initRecordArg2 = { "file", iocshArgString };
+  static const iocshArg * const initRecordArgs[] = { &initRecordArg0, &initRecordArg1, &initRecordArg2 };
+  static const iocshFuncDef initRecordFuncDef = { "vmeRecordConfigure", 3, initRecordArgs };
+  static void initRecordCallFunc( const iocshArgBuf *args ) {
+    vmeRecordConfigure( args[0].sval, args[1].sval, args[2].sval );
+  }
+  
+  //----------------------------------------------------------------------------
+  //! @brief   Register functions to EPICS
+  //----------------------------------------------------------------------------
+  void VmeMasterRecorderRegister( void ) {
+    static int firstTime = 1;
+    if ( firstTime ) {
+      iocshRegister( &initRecordFuncDef, initRecordCallFunc );
+      firstTime = 0;
+    }
+  }
+  
+  epicsExportRegistrar( VmeMasterRecorderRegister );
+}
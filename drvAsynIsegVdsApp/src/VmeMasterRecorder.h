@@ -0,0 +1,90 @@
+//******************************************************************************
+// Copyright (C) 2014 Florian Feldbauer <florian@ep1.ruhr-uni-bochum.de>
+//                    - Helmholtz-Institut/University Mainz, Institute for nuclear physics
+//                    Matthias Steinke <matthias@ep1.ruhr-uni-bochum.de>
+//                    - University Bochum, Intitue for experimental physics I
+//
+// This file is part of drvAsynIsegVds
+//
+// drvAsynIsegVds is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// drvAsynIsegVds is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+//
+// version 1.5.0; Sep. 11, 2014
+//******************************************************************************
+
+#pragma once
+
+//_____ I N C L U D E S _______________________________________________________
+#include <cstdio>
+#include <stdint.h>
+
+#include <epicsMutex.h>
+#include <epicsTime.h>
+
+#include "VmeMaster.h"
+
+//_____ D E F I N I T I O N S __________________________________________________
+
+//! @brief   VME master recording the register traffic of another link
+//!
+//! All accesses are passed to the recorded link and written to a text file
+//! afterwards, one line per cycle:
+//!
+//!     <time> R|W <space> <width> <address> <value> <status>
+//!     <time> B <space> <address> <words> <status> <value> ...
+//!
+//! time is in seconds since the recording started, space 16, 24 or 32,
+//! width the number of bytes, address and values are hex, status is the
+//! VmeMaster::Status of the access. B lines are block reads. Transaction
+//! lists are recorded as their single cycles. Each access is recorded
+//! before this link is unlocked, so the lines are in the order of the
+//! accesses on the bus as long as all ports use this link and none the
+//! recorded one directly. The file can be replayed by VmeMasterReplay.
+class VmeMasterRecorder : public VmeMaster {
+ public: 
+  static void create( const char* name, const char* link, const char* file );
+
+  Status   tryRead ( AddressSpace, DataWidth, uint32_t, uint32_t& );
+  Status   tryWrite( AddressSpace, DataWidth, uint32_t, uint32_t );
+  Status   tryBlockRead( AddressSpace, TransferMode, uint32_t, uint32_t, uint32_t, uint32_t* );
+  Status   tryExecute( TransactionList&, size_t& );
+
+  int32_t  fifoBltRead( uint32_t, uint32_t, uint32_t, uint32_t* );
+  int32_t  bltRead( uint32_t, uint32_t, uint32_t, uint32_t* );
+
+  bool     reconnect();
+  bool     irqSupported() const;
+  Status   tryWaitForIrq( int level, double timeout, uint32_t* vector, bool& received );
+  bool     mapWindow( AddressSpace space, uint32_t baseAddress, uint32_t size );
+
+  void     report( FILE *fp, int details );
+  void     flush();
+
+ private:
+  VmeMasterRecorder( VmeMaster* link, FILE* file );
+  VmeMasterRecorder( const VmeMasterRecorder& );             // not implemented, the link is not copyable
+  VmeMasterRecorder& operator=( const VmeMasterRecorder& );  // not implemented
+  virtual ~VmeMasterRecorder();
+
+  void     count( Status status, unsigned long bytes );
+  void     record( char type, AddressSpace space, DataWidth width, uint32_t address,
+                   uint32_t value, Status status );
+
+  VmeMaster*     _link;     //!< recorded link
+  FILE*          _file;     //!< recording, protected by _fileLock
+  epicsMutex     _fileLock;
+  epicsTimeStamp _start;    //!< time of the first line
+  unsigned long  _lines;    //!< number of lines written, protected by _fileLock
+
+};
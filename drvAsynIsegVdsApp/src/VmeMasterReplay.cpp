@@ -0,0 +1,295 @@
+//******************************************************************************
+// Copyright (C) 2014 Florian Feldbauer <florian@ep1.ruhr-uni-bochum.de>
+//                    - Helmholtz-Institut/University Mainz, Institute for nuclear physics
+//                    Matthias Steinke <matthias@ep1.ruhr-uni-bochum.de>
+//                    - University Bochum, Intitue for experimental physics I
+//
+// This file is part of drvAsynIsegVds
+//
+// drvAsynIsegVds is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// drvAsynIsegVds is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+//
+// version 1.5.0; Sep. 11, 2014
+//******************************************************************************
+
+//_____ I N C L U D E S _______________________________________________________
+
+// ANSI C/C++ includes
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+
+// EPICS includes
+#include <epicsExport.h>
+#include <epicsTime.h>
+#include <iocsh.h>
+
+// local includes
+#include "VmeMasterReplay.h"
+
+//_____ D E F I N I T I O N S __________________________________________________
+
+//_____ G L O B A L S __________________________________________________________
+
+//_____ L O C A L S ____________________________________________________________
+
+//_____ F U N C T I O N S ______________________________________________________
+
+//------------------------------------------------------------------------------
+VmeMasterReplay::VmeMasterReplay( double latency )
+  : VmeMaster(),
+    _latency( latency ),
+    _samples( 0 ),
+    _exhausted( 0 ),
+    _unknown( 0 ),
+    _mismatches( 0 )
+{}
+
+//------------------------------------------------------------------------------
+VmeMasterReplay::~VmeMasterReplay() {}
+
+//------------------------------------------------------------------------------
+//! @brief   Creates an instance of class VmeMasterReplay
+//! @param   [in] name     name of the link used by the drivers
+//! @param   [in] file     recording of VmeMasterRecorder
+//! @param   [in] latency  duration of each access in seconds
+//------------------------------------------------------------------------------
+void VmeMasterReplay::create( const char* name, const char* file, double latency ) {
+  if ( exists( name ) ) {
+    std::cerr << "VME link " << name << " has already been created" << std::endl;
+    return;
+  }
+  FILE* fp = fopen( file, "r" );
+  if( !fp ) {
+    std::cerr << "Could not open " << file << ": " << strerror( errno ) << std::endl;
+    return;
+  }
+  VmeMasterReplay* replay = new VmeMasterReplay( latency );
+  bool loaded = replay->load( fp );
+  fclose( fp );
+  if( !loaded ) {
+    std::cerr << file << " is not a valid recording, error at access " << replay->_samples + 1 << std::endl;
+    delete replay;
+    return;
+  }
+  addInstance( name, replay );
+}
+
+//------------------------------------------------------------------------------
+//! @brief   Key of a register in the sequence maps
+//------------------------------------------------------------------------------
+uint64_t VmeMasterReplay::key( AddressSpace space, DataWidth width, uint32_t address ) {
+  return ( (uint64_t)space << 40 ) | ( (uint64_t)width << 32 ) | address;
+}
+
+//------------------------------------------------------------------------------
+//! @brief   Append a recorded access to the sequence of its register
+//------------------------------------------------------------------------------
+void VmeMasterReplay::add( SequenceMap& map, AddressSpace space, DataWidth width, uint32_t address,
+                           uint32_t value, Status status ) {
+  Sequence& sequence = map[key( space, width, address )];
+  Sample sample = { value, status };
+  sequence.samples.push_back( sample );
+}
+
+//------------------------------------------------------------------------------
+//! @brief   Read a recording, see VmeMasterRecorder for the format
+//! @param   [in]  file  opened recording
+//! @return  false if the file is not a valid recording
+//------------------------------------------------------------------------------
+bool VmeMasterReplay::load( FILE* file ) {
+  double time;
+  char type;
+  while( 2 == fscanf( file, "%lf %c", &time, &type ) ) {
+    int bits = 0, width = 4, status = 0;
+    unsigned int address = 0, value = 0, words = 0;
+    if( 'R' == type || 'W' == type ) {
+      if( 5 != fscanf( file, "%d %d %x %x %d", &bits, &width, &address, &value, &status ) ) return false;
+    } else if( 'B' == type ) {
+      if( 4 != fscanf( file, "%d %x %u %d", &bits, &address, &words, &status ) ) return false;
+    } else {
+      return false;
+    }
+
+    AddressSpace space;
+    switch( bits ) {
+      case 16: space = A16; break;
+      case 24: space = A24; break;
+      case 32: space = A32; break;
+      default: return false;
+    }
+    if( WIDTH8 != width && WIDTH16 != width && WIDTH32 != width ) return false;
+    if( status < SUCCESS || status > NOT_SUPPORTED ) return false;
+
+    if( 'B' == type ) {
+      // block reads are replayed by single D32 cycles
+      if( status ) add( _reads, space, WIDTH32, address, 0, (Status)status );
+      for( unsigned int i = 0; i < words; ++i ) {
+        if( 1 != fscanf( file, "%x", &value ) ) return false;
+        add( _reads, space, WIDTH32, address + 4 * i, value, SUCCESS );
+      }
+    } else {
+      add( 'R' == type ? _reads : _writes, space, (DataWidth)width, address, value, (Status)status );
+    }
+    ++_samples;
+  }
+  return feof( file );
+}
+
+//------------------------------------------------------------------------------
+//! @brief   Simulated duration of an access
+//------------------------------------------------------------------------------
+void VmeMasterReplay::wait() const {
+  if( _latency <= 0. ) return;
+  epicsTimeStamp start, now;
+  epicsTimeGetCurrent( &start );
+  do {
+    epicsTimeGetCurrent( &now );
+  } while( epicsTimeDiffInSeconds( &now, &start ) < _latency );
+}
+
+//------------------------------------------------------------------------------
+//! @brief   Next recorded value of a register
+//! @return  BUS_ERROR for registers not recorded, the recorded status otherwise
+//------------------------------------------------------------------------------
+VmeMaster::Status VmeMasterReplay::tryRead( AddressSpace space, DataWidth width, uint32_t address, uint32_t& value ) {
+  if( !isLinkUp() ) return LINK_DOWN;
+  LinkGuard guard( *this );
+  wait();
+
+  SequenceMap::iterator it = _reads.find( key( space, width, address ) );
+  if( it == _reads.end() ) {
+    ++_unknown;
+    countError( EIO );
+    return BUS_ERROR;
+  }
+  Sequence& sequence = it->second;
+  const Sample& sample = sequence.samples[sequence.next < sequence.samples.size() ? sequence.next
+                                                                                  : sequence.samples.size() - 1];
+  if( sequence.next < sequence.samples.size() ) ++sequence.next;
+  else                                          ++_exhausted;
+
+  if( sample.status ) {
+    countError( EIO );
+    return sample.status;
+  }
+  value = sample.value;
+  countTransfer( width );
+  return SUCCESS;
+}
+
+//------------------------------------------------------------------------------
+//! @brief   Compare a write with the next recorded write of the register
+//! @return  the recorded status, SUCCESS for writes not recorded
+//------------------------------------------------------------------------------
+VmeMaster::Status VmeMasterReplay::tryWrite( AddressSpace space, DataWidth width, uint32_t address, uint32_t value ) {
+  if( !isLinkUp() ) return LINK_DOWN;
+  LinkGuard guard( *this );
+  wait();
+
+  SequenceMap::iterator it = _writes.find( key( space, width, address ) );
+  if( it == _writes.end() || it->second.next == it->second.samples.size() ) {
+    ++_mismatches;
+    countTransfer( width );
+    return SUCCESS;
+  }
+  const Sample& sample = it->second.samples[it->second.next++];
+  if( sample.value != value ) ++_mismatches;
+  if( sample.status ) {
+    countError( EIO );
+    return sample.status;
+  }
+  countTransfer( width );
+  return SUCCESS;
+}
+
+//------------------------------------------------------------------------------
+//! @brief   A32 block reads are replayed by single cycles
+//------------------------------------------------------------------------------
+int32_t VmeMasterReplay::fifoBltRead( uint32_t baseAddress, uint32_t subAddress, 
+                                      uint32_t wordsToRead, uint32_t* buffer ) {
+  return blockRead( A32, BLT32, baseAddress, subAddress, wordsToRead, buffer );
+}
+
+//------------------------------------------------------------------------------
+//! @brief   A32 block reads are replayed by single cycles
+//------------------------------------------------------------------------------
+int32_t VmeMasterReplay::bltRead( uint32_t baseAddress, uint32_t subAddress, 
+                                  uint32_t wordsToRead, uint32_t* buffer ) {
+  return blockRead( A32, BLT32, baseAddress, subAddress, wordsToRead, buffer );
+}
+
+//------------------------------------------------------------------------------
+//! @brief   Print the progress of the replay and the statistics
+//------------------------------------------------------------------------------
+void VmeMasterReplay::report( FILE *fp, int details ) {
+  unsigned long exhausted, unknown, mismatches;
+  {
+    LinkGuard guard( *this );
+    exhausted  = _exhausted;
+    unknown    = _unknown;
+    mismatches = _mismatches;
+  }
+  fprintf( fp, "Replayed VME master: latency %g us, %lu recorded accesses of %lu registers\n",
+           _latency * 1.e6, _samples, (unsigned long)( _reads.size() + _writes.size() ) );
+  fprintf( fp, "  %lu reads after end of recording, %lu reads not recorded, %lu writes differing\n",
+           exhausted, unknown, mismatches );
+  VmeMaster::report( fp, details );
+}
+
+// Configuration routines. Called directly, or from the iocsh function below
+extern "C" {
+  
+  //----------------------------------------------------------------------------
+  //! @brief   EPICS iocsh callable function to call constructor
+  //!          for the VmeMasterReplay class.
+  //!
+  //! @param  [in]  name     The name of the link (e.g. "replay")
+  //! @param  [in]  file     The recording of vmeRecordConfigure
+  //! @param  [in]  latency  Duration of each access in microseconds
+  //----------------------------------------------------------------------------
+  int vmeReplayConfigure( const char *name, const char *file, const double latency ) {
+    if( !name || !name[0] ) {
+      fprintf( stderr, "vmeReplayConfigure: No link name given\n" );
+      return -1;
+    }
+    if( !file || !file[0] ) {
+      fprintf( stderr, "vmeReplayConfigure: No file given\n" );
+      return -1;
+    }
+    VmeMasterReplay::create( name, file, latency * 1.e-6 );
+    return 0;
+  }
+  static const iocshArg initReplayArg0 = { "name",    iocshArgString };
+  static const iocshArg initReplayArg1 = { "file",    iocshArgString };
+  static const iocshArg initReplayArg2 = { "latency", iocshArgDouble };
+  static const iocshArg * const initReplayArgs[] = { &initReplayArg0, &initReplayArg1, &initReplayArg2 };
+  static const iocshFuncDef initReplayFuncDef = { "vmeReplayConfigure", 3, initReplayArgs };
+  static void initReplayCallFunc( const iocshArgBuf *args ) {
+    vmeReplayConfigure( args[0].sval, args[1].sval, args[2].dval );
+  }
+  
+  //----------------------------------------------------------------------------
+  //! @brief   Register functions to EPICS
+  //----------------------------------------------------------------------------
+  void VmeMasterReplayRegister( void ) {
+    static int firstTime = 1;
+    if ( firstTime ) {
+      iocshRegister( &initReplayFuncDef, initReplayCallFunc );
+      firstTime = 0;
+    }
+  }
+  
+  epicsExportRegistrar( VmeMasterReplayRegister );
+}
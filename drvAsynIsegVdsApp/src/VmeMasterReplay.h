@@ -0,0 +1,95 @@
+//******************************************************************************
+// Copyright (C) 2014 Florian Feldbauer <florian@ep1.ruhr-uni-bochum.de>
+//                    - Helmholtz-Institut/University Mainz, Institute for nuclear physics
+//                    Matthias Steinke <matthias@ep1.ruhr-uni-bochum.de>
+//                    - University Bochum, Intitue for experimental physics I
+//
+// This file is part of drvAsynIsegVds
+//
+// drvAsynIsegVds is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// drvAsynIsegVds is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+//
+// version 1.5.0; Sep. 11, 2014
+//******************************************************************************
+
+#pragma once
+
+//_____ I N C L U D E S _______________________________________________________
+#include <cstdio>
+#include <stdint.h>
+#include <map>
+#include <vector>
+
+#include "VmeMaster.h"
+
+//_____ D E F I N I T I O N S __________________________________________________
+
+//! @brief   VME master replaying a recording of VmeMasterRecorder
+//!
+//! Each register answers with the values recorded for it, in the order
+//! they have been recorded, independent of the timing and the order of
+//! the accesses to other registers. After the last recorded value a
+//! register keeps answering with it. Registers which have not been read
+//! during the recording fail with a bus error. Writes are compared with
+//! the recorded writes of the register, differences are counted. Failed
+//! accesses of the recording fail again with the recorded status.
+//! Interrupts are not replayed, drivers have to poll.
+class VmeMasterReplay : public VmeMaster {
+ public: 
+  static void create( const char* name, const char* file, double latency );
+
+  Status   tryRead ( AddressSpace, DataWidth, uint32_t, uint32_t& );
+  Status   tryWrite( AddressSpace, DataWidth, uint32_t, uint32_t );
+
+  int32_t  fifoBltRead( uint32_t, uint32_t, uint32_t, uint32_t* );
+  int32_t  bltRead( uint32_t, uint32_t, uint32_t, uint32_t* );
+
+  void     report( FILE *fp, int details );
+
+ private:
+  VmeMasterReplay( double latency );
+  VmeMasterReplay( const VmeMasterReplay& );             // not implemented, the link is not copyable
+  VmeMasterReplay& operator=( const VmeMasterReplay& );  // not implemented
+  virtual ~VmeMasterReplay();
+
+  //! One recorded access of a register
+  typedef struct {
+    uint32_t value;   //!< value read or written
+    Status   status;  //!< result of the access
+  } Sample;
+
+  //! Recorded accesses of one register and the position of the replay
+  typedef struct {
+    std::vector<Sample> samples;
+    size_t              next;   //!< next sample to replay
+  } Sequence;
+
+  typedef std::map<uint64_t, Sequence> SequenceMap;
+
+  static uint64_t key( AddressSpace space, DataWidth width, uint32_t address );
+
+  bool     load( FILE* file );
+  void     add( SequenceMap& map, AddressSpace space, DataWidth width, uint32_t address,
+                uint32_t value, Status status );
+  void     wait() const;
+
+  double        _latency;     //!< duration of each access in seconds
+  SequenceMap   _reads;       //!< recorded reads by register
+  SequenceMap   _writes;      //!< recorded writes by register
+  unsigned long _samples;     //!< number of recorded accesses
+  unsigned long _exhausted;   //!< reads after the last recorded value
+  unsigned long _unknown;     //!< accesses of registers not recorded
+  unsigned long _mismatches;  //!< writes differing from the recording
+
+};
@@ -35,10 +35,13 @@
 #include <cstring>
 #include <fcntl.h>
 #include <sys/ioctl.h>
+#include <sys/mman.h>
 #include <sis3100_vme_calls.h>
 
 // EPICS includes
 #include <epicsExport.h>
+#include <epicsThread.h>
+#include <epicsTime.h>
 #include <iocsh.h>
 
 // local includes
@@ -49,199 +52,218 @@
 //_____ G L O B A L S __________________________________________________________
 
 //_____ L O C A L S ____________________________________________________________
+// map descriptors of the SIS3100, descriptor n at sisMapDescriptor + 16 * n
+// holds header, address modifier and VME address bits 31..22 (low, high)
+static const int      sisMapDescriptor  = 0x400;
+static const int      sisMapDescriptors = 64;
+static const uint32_t sisMapHeader      = 0xff010800;  //!< remote space, all byte lanes enabled
+static const uint32_t sisMapA16         = 0x29;        //!< A16 non-privileged, as used by vme_A16Dxx
+static const uint32_t sisBusErrorData   = 0xffffffff;  //!< data of a mapped read terminated with BERR
+static const double   sisIrqPoll        = 0.005;       //!< interval of checking for pending interrupts in seconds
 
 //_____ F U N C T I O N S ______________________________________________________
 
 //------------------------------------------------------------------------------
 VmeMasterSIS3100::VmeMasterSIS3100()
-  : VmeMaster()
+  : VmeMaster(),
+    _sisHandle( -1 ),
+    _irqMask( 0 ),
+    _mapped( false ),
+    _a16Pages( 0 ),
+    _a16Map( 0 ),
+    _mapSize( 0 )
 {}
 
 //------------------------------------------------------------------------------
-VmeMasterSIS3100::VmeMasterSIS3100( const char* devName )
-  : VmeMaster()
+//! @brief   Open the device
+//!
+//! If the device cannot be opened the link starts in the link down state,
+//! reconnect() retries to open it.
+//!
+//! @param   [in] devName  file system name of device
+//! @param   [in] mapped   use the memory mapped A16 space for windows
+//!                        announced with mapWindow()
+//------------------------------------------------------------------------------
+VmeMasterSIS3100::VmeMasterSIS3100( const char* devName, bool mapped )
+  : VmeMaster(),
+    _devName( devName ),
+    _sisHandle( -1 ),
+    _irqMask( 0 ),
+    _mapped( mapped ),
+    _a16Pages( 0 ),
+    _a16Map( 0 ),
+    _mapSize( 0 )
 {
-  if( ( _sisHandle = open( devName, O_RDWR, 0 ) ) < 0 ) {
-    std::cerr << "open of " << devName << " failed" << std::endl;
-    exit(1);
+  if( !openDevice() ) {
+    std::cerr << "open of " << devName << " failed: " << strerror( errno ) << std::endl;
+    setLinkDown();
   }
-
-  unsigned int value = 0xffffffff;
-  int result;
-  result = s3100_control_read( _sisHandle, 0x12000000 + 0, &value );
-  //  std::cerr << "SIS3100: 0 " << std::hex << value << " return code " << result << std::endl;
-  result = s3100_control_read( _sisHandle, 0x12000000 + 4, &value );
-  //  std::cerr << "SIS3100: 4 " << std::hex << value << " return code " << result << std::dec << std::endl;
 }
 
 //------------------------------------------------------------------------------
 VmeMasterSIS3100::~VmeMasterSIS3100() {
-  close( _sisHandle );
+  unmapA16();
+  if( _sisHandle >= 0 ) close( _sisHandle );
 }
 
 //------------------------------------------------------------------------------
-VmeMasterSIS3100::VmeMasterSIS3100( const VmeMasterSIS3100& rother ) {}
-
-//------------------------------------------------------------------------------
-//! @brief   Creates an instance of class VmeMasterSIS3100
-//! @param   [in] devName  file system name of device
+//! @brief   (Re)open the device and check that the link answers
+//!
+//! Reads the identification and status registers of the SIS1100.
+//! @return  false if the device could not be opened or the link is not up
 //------------------------------------------------------------------------------
-void VmeMasterSIS3100::create( const char* devName ) {
-  if ( _pinstance )
-    std::cerr << "VME Singleton has already been created" << std::endl;
-  else
-    _pinstance = new VmeMasterSIS3100( devName );
+bool VmeMasterSIS3100::openDevice() {
+  unmapA16();
+  if( _sisHandle >= 0 ) close( _sisHandle );
+  _irqMask = 0;
+  if( ( _sisHandle = open( _devName.c_str(), O_RDWR, 0 ) ) < 0 ) return false;
+
+  unsigned int value = 0xffffffff;
+  if( s3100_control_read( _sisHandle, 0x12000000 + 0, &value ) != 0 ||
+      s3100_control_read( _sisHandle, 0x12000000 + 4, &value ) != 0 ) {
+    close( _sisHandle );
+    _sisHandle = -1;
+    return false;
+  }
+  if( _mapped && _a16Pages && !mapA16() )
+    std::cerr << "mapping of A16 space of " << _devName << " failed, using single cycles" << std::endl;
+  return true;
 }
 
 //------------------------------------------------------------------------------
+//! @brief   Map the A16 space into the process
+//!
+//! Uses the first map descriptor of the SIS3100 for the whole A16 space,
+//! with the address modifier of the single cycle library calls.
+//! @return  false if the sis1100 driver does not support mapping
+//------------------------------------------------------------------------------
+bool VmeMasterSIS3100::mapA16() {
+#ifdef SIS1100_MAPSIZE
+  if( _a16Map ) return true;
+  u_int32_t size = 0;
+  if( ioctl( _sisHandle, SIS1100_MAPSIZE, &size ) < 0 ) return false;
+  size /= sisMapDescriptors;
+  if( size < 0x10000 ) return false;
 
-void VmeMasterSIS3100::writeRegisterA16D8 ( uint32_t baseAddress, uint32_t subAddress, uint8_t value ) {
-  if( vme_A16D8_write( _sisHandle, baseAddress + subAddress, value ) != 0 ) {
-    char errmsg[255];
-    sprintf( errmsg, "Could not write to VMEbus: %s(%d)", strerror( errno ), errno );
-    throw VmeException( errmsg );
-  }
-}
-void VmeMasterSIS3100::writeRegisterA16D16 ( uint32_t baseAddress, uint32_t subAddress, uint16_t value ) {
-  if( vme_A16D16_write( _sisHandle, baseAddress + subAddress, value ) != 0 ) {
-    char errmsg[255];
-    sprintf( errmsg, "Could not write to VMEbus: %s(%d)", strerror( errno ), errno );
-    throw VmeException( errmsg );
-  }
-}
-void VmeMasterSIS3100::writeRegisterA16D32 ( uint32_t baseAddress, uint32_t subAddress, uint32_t value ) {
-  if( vme_A16D32_write( _sisHandle, baseAddress + subAddress, value ) != 0 ) {
-    char errmsg[255];
-    sprintf( errmsg, "Could not write to VMEbus: %s(%d)", strerror( errno ), errno );
-    throw VmeException( errmsg );
-  }
-}
-uint8_t VmeMasterSIS3100::readRegisterA16D8 ( uint32_t baseAddress, uint32_t subAddress ) {
-  uint8_t value = 0xff;
-  if( vme_A16D8_read( _sisHandle, baseAddress + subAddress, &value ) != 0 ) {
-    char errmsg[255];
-    sprintf( errmsg, "Could not read from VMEbus: %s(%d)", strerror( errno ), errno );
-    throw VmeException( errmsg );
-  }
-  return value;
-}
-uint16_t VmeMasterSIS3100::readRegisterA16D16 ( uint32_t baseAddress, uint32_t subAddress ) {
-  uint16_t value = 0xff;
-  if( vme_A16D16_read( _sisHandle, baseAddress + subAddress, &value ) != 0 ) {
-    char errmsg[255];
-    sprintf( errmsg, "Could not read from VMEbus: %s(%d)", strerror( errno ), errno );
-    throw VmeException( errmsg );
-  }
-  return value;
-}
-uint32_t VmeMasterSIS3100::readRegisterA16D32 ( uint32_t baseAddress, uint32_t subAddress ) {
-  uint32_t value = 0xff;
-  if( vme_A16D32_read( _sisHandle, baseAddress + subAddress, &value ) != 0 ) {
-    char errmsg[255];
-    sprintf( errmsg, "Could not read from VMEbus: %s(%d)", strerror( errno ), errno );
-    throw VmeException( errmsg );
-  }
-  return value;
-}
-void VmeMasterSIS3100::writeRegisterA24D8 ( uint32_t baseAddress, uint32_t subAddress, uint8_t value ) {
-  if( vme_A24D8_write( _sisHandle, baseAddress + subAddress, value ) != 0 ) {
-    char errmsg[255];
-    sprintf( errmsg, "Could not write to VMEbus: %s(%d)", strerror( errno ), errno );
-    throw VmeException( errmsg );
-  }
-}
-void VmeMasterSIS3100::writeRegisterA24D16 ( uint32_t baseAddress, uint32_t subAddress, uint16_t value ) {
-  if( vme_A24D16_write( _sisHandle, baseAddress + subAddress, value ) != 0 ) {
-    char errmsg[255];
-    sprintf( errmsg, "Could not write to VMEbus: %s(%d)", strerror( errno ), errno );
-    throw VmeException( errmsg );
-  }
-}
-void VmeMasterSIS3100::writeRegisterA24D32 ( uint32_t baseAddress, uint32_t subAddress, uint32_t value ) {
-  if( vme_A24D32_write( _sisHandle, baseAddress + subAddress, value ) != 0 ) {
-    char errmsg[255];
-    sprintf( errmsg, "Could not write to VMEbus: %s(%d)", strerror( errno ), errno );
-    throw VmeException( errmsg );
-  }
-}
-uint8_t VmeMasterSIS3100::readRegisterA24D8 ( uint32_t baseAddress, uint32_t subAddress ) {
-  uint8_t value = 0xff;
-  if( vme_A24D8_read( _sisHandle, baseAddress + subAddress, &value ) != 0 ) {
-    char errmsg[255];
-    sprintf( errmsg, "Could not read from VMEbus: %s(%d)", strerror( errno ), errno );
-    throw VmeException( errmsg );
-  }
-  return value;
+  if( s3100_control_write( _sisHandle, sisMapDescriptor + 0x0, sisMapHeader ) != 0 ||
+      s3100_control_write( _sisHandle, sisMapDescriptor + 0x4, sisMapA16 )    != 0 ||
+      s3100_control_write( _sisHandle, sisMapDescriptor + 0x8, 0 )            != 0 ||
+      s3100_control_write( _sisHandle, sisMapDescriptor + 0xc, 0 )            != 0 )
+    return false;
+
+  void *map = mmap( 0, size, PROT_READ | PROT_WRITE, MAP_SHARED, _sisHandle, 0 );
+  if( MAP_FAILED == map ) return false;
+  _a16Map  = (volatile char *)map;
+  _mapSize = size;
+  return true;
+#else
+  return false;
+#endif
 }
-uint16_t VmeMasterSIS3100::readRegisterA24D16 ( uint32_t baseAddress, uint32_t subAddress ) {
-  uint16_t value = 0xff;
-  if( vme_A24D16_read( _sisHandle, baseAddress + subAddress, &value ) != 0 ) {
-    char errmsg[255];
-    sprintf( errmsg, "Could not read from VMEbus: %s(%d)", strerror( errno ), errno );
-    throw VmeException( errmsg );
-  }
-  return value;
+
+//------------------------------------------------------------------------------
+//! @brief   Release the mapping of the A16 space
+//------------------------------------------------------------------------------
+void VmeMasterSIS3100::unmapA16() {
+  if( !_a16Map ) return;
+  munmap( (void *)_a16Map, _mapSize );
+  _a16Map  = 0;
+  _mapSize = 0;
 }
-uint32_t VmeMasterSIS3100::readRegisterA24D32 ( uint32_t baseAddress, uint32_t subAddress ) {
-  uint32_t value = 0xff;
-  if( vme_A24D32_read( _sisHandle, baseAddress + subAddress, &value ) != 0 ) {
-    char errmsg[255];
-    sprintf( errmsg, "Could not read from VMEbus: %s(%d)", strerror( errno ), errno );
-    throw VmeException( errmsg );
+
+//------------------------------------------------------------------------------
+//! @brief   Use the mapped A16 space for single D32 reads within a window
+//!
+//! Only A16 is mapped, all modules of a crate fit into one descriptor.
+//! Writes stay on the library calls, their errors are reported reliably.
+//------------------------------------------------------------------------------
+bool VmeMasterSIS3100::mapWindow( AddressSpace space, uint32_t baseAddress, uint32_t size ) {
+  if( !_mapped || A16 != space || 0 == size || baseAddress + size > 0x10000 ) return false;
+
+  LinkGuard guard( *this );
+  for( uint32_t page = baseAddress >> 10; page <= ( baseAddress + size - 1 ) >> 10; ++page )
+    _a16Pages |= (uint64_t)1 << page;
+  if( !_a16Map && _sisHandle >= 0 && !mapA16() ) {
+    std::cerr << "mapping of A16 space of " << _devName << " failed, using single cycles" << std::endl;
+    _mapped = false;
   }
-  return value;
+  return ( _a16Map != 0 );
 }
-void VmeMasterSIS3100::writeRegisterA32D8 ( uint32_t baseAddress, uint32_t subAddress, uint8_t value ) {
-  if( vme_A32D8_write( _sisHandle, baseAddress + subAddress, value ) != 0 ) {
-    char errmsg[255];
-    sprintf( errmsg, "Could not write to VMEbus: %s(%d)", strerror( errno ), errno );
-    throw VmeException( errmsg );
-  }
+
+//------------------------------------------------------------------------------
+//! @brief   Reopen the device after the link went down
+//! @return  true if the link is up
+//------------------------------------------------------------------------------
+bool VmeMasterSIS3100::reconnect() {
+  LinkGuard guard( *this );
+  if( isLinkUp() ) return true;
+  if( !openDevice() ) return false;
+  return VmeMaster::reconnect();
 }
-void VmeMasterSIS3100::writeRegisterA32D16 ( uint32_t baseAddress, uint32_t subAddress, uint16_t value ) {
-  if( vme_A32D16_write( _sisHandle, baseAddress + subAddress, value ) != 0 ) {
-    char errmsg[255];
-    sprintf( errmsg, "Could not write to VMEbus: %s(%d)", strerror( errno ), errno );
-    throw VmeException( errmsg );
+
+//------------------------------------------------------------------------------
+//! @brief   Creates an instance of class VmeMasterSIS3100
+//! @param   [in] name     name of the link used by the drivers
+//! @param   [in] devName  file system name of device
+//! @param   [in] mapped   use the memory mapped A16 space
+//------------------------------------------------------------------------------
+void VmeMasterSIS3100::create( const char* name, const char* devName, bool mapped ) {
+  if ( exists( name ) ) {
+    std::cerr << "VME link " << name << " has already been created" << std::endl;
+    return;
   }
+  VmeMasterSIS3100* instance = new VmeMasterSIS3100( devName, mapped );
+  addInstance( name, instance );
 }
-void VmeMasterSIS3100::writeRegisterA32D32 ( uint32_t baseAddress, uint32_t subAddress, uint32_t value ) {
-  if( vme_A32D32_write( _sisHandle, baseAddress + subAddress, value ) != 0 ) {
-    char errmsg[255];
-    sprintf( errmsg, "Could not write to VMEbus: %s(%d)", strerror( errno ), errno );
-    throw VmeException( errmsg );
+
+//------------------------------------------------------------------------------
+//! @brief   Single read cycle with the link locked
+//!
+//! Fails with LINK_DOWN without calling the SIS3100 library while the link
+//! is down.
+//------------------------------------------------------------------------------
+VmeMaster::Status VmeMasterSIS3100::tryRead( AddressSpace space, DataWidth width, uint32_t address, uint32_t& value ) {
+  if( !isLinkUp() ) return LINK_DOWN;
+  Transaction t = readCycle( space, width, address );
+  int status, error;
+  {
+    LinkGuard guard( *this );
+    status = sisCycle( t );
+    error  = errno;
   }
-}
-uint8_t VmeMasterSIS3100::readRegisterA32D8 ( uint32_t baseAddress, uint32_t subAddress ) {
-  uint8_t value = 0xff;
-  if( vme_A32D8_read( _sisHandle, baseAddress + subAddress, &value ) != 0 ) {
-    char errmsg[255];
-    sprintf( errmsg, "Could not read from VMEbus: %s(%d)", strerror( errno ), errno );
-    throw VmeException( errmsg );
+  if( status != 0 ) {
+    countError( error );
+    return BUS_ERROR;
   }
-  return value;
+  countTransfer( width );
+  value = t.value;
+  return SUCCESS;
 }
-uint16_t VmeMasterSIS3100::readRegisterA32D16 ( uint32_t baseAddress, uint32_t subAddress ) {
-  uint16_t value = 0xff;
-  if( vme_A32D16_read( _sisHandle, baseAddress + subAddress, &value ) != 0 ) {
-    char errmsg[255];
-    sprintf( errmsg, "Could not read from VMEbus: %s(%d)", strerror( errno ), errno );
-    throw VmeException( errmsg );
+
+//------------------------------------------------------------------------------
+//! @brief   Single write cycle with the link locked
+//------------------------------------------------------------------------------
+VmeMaster::Status VmeMasterSIS3100::tryWrite( AddressSpace space, DataWidth width, uint32_t address, uint32_t value ) {
+  if( !isLinkUp() ) return LINK_DOWN;
+  Transaction t = writeCycle( space, width, address, value );
+  int status, error;
+  {
+    LinkGuard guard( *this );
+    status = sisCycle( t );
+    error  = errno;
   }
-  return value;
-}
-uint32_t VmeMasterSIS3100::readRegisterA32D32 ( uint32_t baseAddress, uint32_t subAddress ) {
-  uint32_t value = 0xff;
-  if( vme_A32D32_read( _sisHandle, baseAddress + subAddress, &value ) != 0 ) {
-    char errmsg[255];
-    sprintf( errmsg, "Could not read from VMEbus: %s(%d)", strerror( errno ), errno );
-    throw VmeException( errmsg );
+  if( status != 0 ) {
+    countError( error );
+    return BUS_ERROR;
   }
-  return value;
+  countTransfer( width );
+  return SUCCESS;
 }
 
 //------------------------------------------------------------------------------
-
+//! @brief   Read from a FIFO with A32 BLT32 cycles
+//! @exception VmeException if the link is down or the transfer failed
+//------------------------------------------------------------------------------
 int32_t VmeMasterSIS3100::fifoBltRead( uint32_t baseAddress, uint32_t subAddress, 
                                        uint32_t wordsToRead, uint32_t* buffer ) {
   uint32_t result = 0;
@@ -250,15 +272,20 @@ int32_t VmeMasterSIS3100::fifoBltRead( uint32_t baseAddress, uint32_t subAddress
   unsigned int transfered = 0;
   unsigned int wordsToTransfer;
   
+  if( !isLinkUp() ) throwError( LINK_DOWN, "read FIFO from", baseAddress + subAddress );
+  LinkGuard guard( *this );
   rest = wordsToRead;
   while( rest > 0 ) {
     wordsToTransfer = (rest <= 8196) ? rest : 8196;
     if ((status = vme_A32BLT32FIFO_read(_sisHandle, baseAddress + subAddress, 
                                         &buffer[transfered], wordsToTransfer, &result)) < 0) {
-      std::cerr << "SIS3100 vme_A32BLT32_read failed with " << status << std::endl;
-      std::cerr << "got " << result << " words" << std::endl;
-      exit(1);
+      countError( errno );
+      char errmsg[255];
+      sprintf( errmsg, "SIS3100 vme_A32BLT32FIFO_read failed with %d after %u words",
+               status, transfered + result );
+      throw VmeException( errmsg );
     }
+    countTransfer( 4 * result );
     rest -= result;
     transfered += result;
   }
@@ -267,7 +294,9 @@ int32_t VmeMasterSIS3100::fifoBltRead( uint32_t baseAddress, uint32_t subAddress
 }
 
 //------------------------------------------------------------------------------
-
+//! @brief   Read a block with A32 BLT32 cycles
+//! @exception VmeException if the link is down or the transfer failed
+//------------------------------------------------------------------------------
 int32_t VmeMasterSIS3100::bltRead( uint32_t baseAddress, uint32_t subAddress, 
                                    uint32_t wordsToRead, uint32_t* buffer ) {
   uint32_t result = 0;
@@ -276,15 +305,20 @@ int32_t VmeMasterSIS3100::bltRead( uint32_t baseAddress, uint32_t subAddress,
   unsigned int transfered = 0;
   unsigned int wordsToTransfer;
   
+  if( !isLinkUp() ) throwError( LINK_DOWN, "read block from", baseAddress + subAddress );
+  LinkGuard guard( *this );
   rest = wordsToRead;
   while (rest > 0) {
     wordsToTransfer = (rest < 8192) ? rest : 8192;
     if ((status = vme_A32BLT32_read( _sisHandle, baseAddress + subAddress, 
                                      &buffer[transfered], wordsToTransfer, &result)) < 0) {
-      std::cerr << "SIS3100 vme_A32BLT32_read failed with " << status << std::endl;
-      std::cerr << "got " << result << " words" << std::endl;
-      exit(1);
+      countError( errno );
+      char errmsg[255];
+      sprintf( errmsg, "SIS3100 vme_A32BLT32_read failed with %d after %u words",
+               status, transfered + result );
+      throw VmeException( errmsg );
     }
+    countTransfer( 4 * result );
     rest -= result;
     transfered += result;
   }
@@ -292,6 +326,211 @@ int32_t VmeMasterSIS3100::bltRead( uint32_t baseAddress, uint32_t subAddress,
   return transfered;
 }
 
+//------------------------------------------------------------------------------
+//! @brief   Read contiguous registers using the block transfer modes of the SIS3100
+//!
+//! A16 has no block transfer address modifiers, D32 is explicitly requesting
+//! single cycles: both fall back to the implementation of VmeMaster.
+//! MBLT64 needs an even number of words, otherwise BLT32 is used.
+//------------------------------------------------------------------------------
+VmeMaster::Status VmeMasterSIS3100::tryBlockRead( AddressSpace space, TransferMode mode,
+                                                  uint32_t baseAddress, uint32_t subAddress,
+                                                  uint32_t wordsToRead, uint32_t* buffer ) {
+  if( A16 == space || D32 == mode )
+    return VmeMaster::tryBlockRead( space, mode, baseAddress, subAddress, wordsToRead, buffer );
+  if( !isLinkUp() ) return LINK_DOWN;
+
+  if( MBLT64 == mode && ( wordsToRead % 2 ) ) mode = BLT32;
+
+  bltFunc_t func;
+  if( A24 == space ) func = ( MBLT64 == mode ) ? vme_A24MBLT64_read : vme_A24BLT32_read;
+  else               func = ( MBLT64 == mode ) ? vme_A32MBLT64_read : vme_A32BLT32_read;
+
+  return sisBlockRead( func, baseAddress + subAddress, wordsToRead, buffer );
+}
+
+//------------------------------------------------------------------------------
+//! @brief   Run a block transfer in chunks accepted by the SIS3100 library
+//!
+//! The link stays locked for all chunks of the transfer.
+//! @return  BUS_ERROR if the transfer failed or was incomplete
+//------------------------------------------------------------------------------
+VmeMaster::Status VmeMasterSIS3100::sisBlockRead( bltFunc_t func, uint32_t address,
+                                                  uint32_t wordsToRead, uint32_t* buffer ) {
+  u_int32_t result = 0;
+  int32_t   status;
+  uint32_t  rest = wordsToRead;
+  uint32_t  transfered = 0;
+  uint32_t  wordsToTransfer;
+
+  LinkGuard guard( *this );
+  while( rest > 0 ) {
+    wordsToTransfer = (rest < 8192) ? rest : 8192;
+    status = func( _sisHandle, address + 4 * transfered, &buffer[transfered], wordsToTransfer, &result );
+    if( status != 0 || result != wordsToTransfer ) {
+      countError( errno );
+      return BUS_ERROR;
+    }
+    countTransfer( 4 * result );
+    rest -= result;
+    transfered += result;
+  }
+
+  return SUCCESS;
+}
+
+//------------------------------------------------------------------------------
+//! @brief   Run one single cycle of a transaction list
+//!
+//! Calls the SIS3100 library directly, the link has to be locked by the caller.
+//! D32 reads within mapped windows are loads from the mapping. A bus error
+//! terminates them with all bits set, only then the read is repeated with
+//! the library call to get the error status.
+//!
+//! @return  status of the SIS3100 library call (0: success)
+//------------------------------------------------------------------------------
+int VmeMasterSIS3100::sisCycle( Transaction& t ) {
+  if( _a16Map && !t.write && A16 == t.space && WIDTH32 == t.width &&
+      t.address < 0x10000 && !( t.address & 3 ) && ( ( _a16Pages >> ( t.address >> 10 ) ) & 1 ) ) {
+    uint32_t data = *(volatile uint32_t *)( _a16Map + t.address );
+    if( sisBusErrorData != data ) {
+      t.value = data;
+      return 0;
+    }
+  }
+
+  int status = -1;
+  u_int8_t  d8  = t.value;
+  u_int16_t d16 = t.value;
+  u_int32_t d32 = t.value;
+
+  switch( t.space ) {
+    case A16:
+      switch( t.width ) {
+        case WIDTH8:  status = t.write ? vme_A16D8_write( _sisHandle, t.address, d8 )   : vme_A16D8_read( _sisHandle, t.address, &d8 );   break;
+        case WIDTH16: status = t.write ? vme_A16D16_write( _sisHandle, t.address, d16 ) : vme_A16D16_read( _sisHandle, t.address, &d16 ); break;
+        case WIDTH32: status = t.write ? vme_A16D32_write( _sisHandle, t.address, d32 ) : vme_A16D32_read( _sisHandle, t.address, &d32 ); break;
+      }
+      break;
+    case A24:
+      switch( t.width ) {
+        case WIDTH8:  status = t.write ? vme_A24D8_write( _sisHandle, t.address, d8 )   : vme_A24D8_read( _sisHandle, t.address, &d8 );   break;
+        case WIDTH16: status = t.write ? vme_A24D16_write( _sisHandle, t.address, d16 ) : vme_A24D16_read( _sisHandle, t.address, &d16 ); break;
+        case WIDTH32: status = t.write ? vme_A24D32_write( _sisHandle, t.address, d32 ) : vme_A24D32_read( _sisHandle, t.address, &d32 ); break;
+      }
+      break;
+    case A32:
+      switch( t.width ) {
+        case WIDTH8:  status = t.write ? vme_A32D8_write( _sisHandle, t.address, d8 )   : vme_A32D8_read( _sisHandle, t.address, &d8 );   break;
+        case WIDTH16: status = t.write ? vme_A32D16_write( _sisHandle, t.address, d16 ) : vme_A32D16_read( _sisHandle, t.address, &d16 ); break;
+        case WIDTH32: status = t.write ? vme_A32D32_write( _sisHandle, t.address, d32 ) : vme_A32D32_read( _sisHandle, t.address, &d32 ); break;
+      }
+      break;
+  }
+
+  if( !t.write && 0 == status ) {
+    switch( t.width ) {
+      case WIDTH8:  t.value = d8;  break;
+      case WIDTH16: t.value = d16; break;
+      case WIDTH32: t.value = d32; break;
+    }
+  }
+  return status;
+}
+
+//------------------------------------------------------------------------------
+//! @brief   Execute a list of single cycles with one lock of the link
+//!
+//! The SIS3100 library has no list mode for single cycles, so the list
+//! is run in a tight loop of library calls without any virtual dispatch
+//! or locking per cycle.
+//------------------------------------------------------------------------------
+VmeMaster::Status VmeMasterSIS3100::tryExecute( TransactionList& list, size_t& executed ) {
+  executed = 0;
+  if( !isLinkUp() ) return LINK_DOWN;
+  LinkGuard guard( *this );
+  for( ; executed < list.size(); ++executed ) {
+    if( sisCycle( list[executed] ) != 0 ) {
+      countError( errno );
+      return BUS_ERROR;
+    }
+    countTransfer( list[executed].width );
+  }
+  return SUCCESS;
+}
+
+//------------------------------------------------------------------------------
+//! @brief   Check if the sis1100 driver provides the interrupt ioctls
+//------------------------------------------------------------------------------
+bool VmeMasterSIS3100::irqSupported() const {
+#ifdef SIS1100_IRQ_WAIT
+  return true;
+#else
+  return false;
+#endif
+}
+
+//------------------------------------------------------------------------------
+//! @brief   Wait for a VME interrupt using the sis1100 interrupt ioctls
+//!
+//! The interrupt level is enabled on first use. SIS1100_IRQ_WAIT blocks
+//! until the interrupt arrives, the kernel driver has no timeout for it.
+//! With a timeout > 0 the pending interrupts are checked with
+//! SIS1100_IRQ_GET every sisIrqPoll seconds instead, until the timeout
+//! expires. The acknowledge re-arms the level. A failing ioctl keeps its
+//! errno for the error message but does not count against the link.
+//------------------------------------------------------------------------------
+VmeMaster::Status VmeMasterSIS3100::tryWaitForIrq( int level, double timeout, uint32_t* vector, bool& received ) {
+  received = false;
+#ifdef SIS1100_IRQ_WAIT
+  if( level < 1 || level > 7 ) return NOT_SUPPORTED;
+  const uint32_t mask = 1 << level;
+
+  if( !( _irqMask & mask ) ) {
+    struct sis1100_irq_ctl ctl;
+    ctl.irq_mask = mask;
+    ctl.signal   = 0;
+    if( ioctl( _sisHandle, SIS1100_IRQ_CTL, &ctl ) < 0 ) {
+      keepError( errno );
+      return BUS_ERROR;
+    }
+    _irqMask |= mask;
+  }
+
+  struct sis1100_irq_get get;
+  get.irq_mask = mask;
+  if( timeout > 0. ) {
+    epicsTimeStamp start, now;
+    epicsTimeGetCurrent( &start );
+    while( true ) {
+      get.irq_mask = mask;
+      if( ioctl( _sisHandle, SIS1100_IRQ_GET, &get ) < 0 ) {
+        if( EINTR == errno ) return SUCCESS;
+        keepError( errno );
+        return BUS_ERROR;
+      }
+      if( get.irqs & mask ) break;
+      epicsTimeGetCurrent( &now );
+      if( epicsTimeDiffInSeconds( &now, &start ) >= timeout ) return SUCCESS;
+      epicsThreadSleep( sisIrqPoll );
+    }
+  } else if( ioctl( _sisHandle, SIS1100_IRQ_WAIT, &get ) < 0 ) {
+    if( EINTR == errno ) return SUCCESS;
+    keepError( errno );
+    return BUS_ERROR;
+  }
+  if( vector ) *vector = get.vector;
+
+  struct sis1100_irq_ack ack;
+  ack.irq_mask = mask;
+  ioctl( _sisHandle, SIS1100_IRQ_ACK, &ack );
+  received = true;
+  return SUCCESS;
+#else
+  return NOT_SUPPORTED;
+#endif
+}
+
 // Configuration routines. Called directly, or from the iocsh function below
 extern "C" {
   
@@ -299,17 +538,30 @@ extern "C" {
   //! @brief   EPICS iocsh callable function to call constructor
   //!          for the VmeMasterSIS3100 class.
   //!
+  //! One IOC can open several links, the drivers select them by name.
+  //! With only one argument the device name is used as link name.
+  //!
+  //! @param  [in]  name     The name of the link (e.g. "link1")
   //! @param  [in]  vmedev   The name of the VME crate on the device file system
+  //! @param  [in]  mapped   1: read module registers through the memory mapped
+  //!                        A16 space, 0: one library call per cycle
   //----------------------------------------------------------------------------
-  int SIS3100Configure( const char *vmedev ) {
-    VmeMasterSIS3100::create( vmedev );
+  int SIS3100Configure( const char *name, const char *vmedev, const int mapped ) {
+    if( !vmedev || !vmedev[0] ) vmedev = name;
+    if( !vmedev || !vmedev[0] ) {
+      fprintf( stderr, "SIS3100Configure: No device given\n" );
+      return -1;
+    }
+    VmeMasterSIS3100::create( name, vmedev, mapped != 0 );
     return 0;
   }
-  static const iocshArg initSis3100Arg0 = { "vmedev", iocshArgString };
-  static const iocshArg * const initSis3100Args[] = { &initSis3100Arg0 };
-  static const iocshFuncDef initSis3100FuncDef = { "SIS3100Configure", 1, initSis3100Args };
+  static const iocshArg initSis3100Arg0 = { "name",   iocshArgString };
+  static const iocshArg initSis3100Arg1 = { "vmedev", iocshArgString };
+  static const iocshArg initSis3100Arg2 = { "mapped", iocshArgInt };
+  static const iocshArg * const initSis3100Args[] = { &initSis3100Arg0, &initSis3100Arg1, &initSis3100Arg2 };
+  static const iocshFuncDef initSis3100FuncDef = { "SIS3100Configure", 3, initSis3100Args };
   static void initSis3100CallFunc( const iocshArgBuf *args ) {
-    SIS3100Configure( args[0].sval );
+    SIS3100Configure( args[0].sval, args[1].sval, args[2].ival );
   }
   
   //----------------------------------------------------------------------------
@@ -29,6 +29,8 @@
 #include <cctype>
 #include <cstdio>
 #include <stdint.h>
+#include <sys/types.h>
+#include <string>
 
 #include "VmeMaster.h"
 
@@ -40,42 +42,42 @@
 //! PCI-VME link
 class VmeMasterSIS3100 : public VmeMaster {
  public: 
-  static void create( const char* );
+  static void create( const char*, const char*, bool mapped = false );
 
-  // A16
-  void     writeRegisterA16D8  ( uint32_t, uint32_t, uint8_t  );
-  void     writeRegisterA16D16 ( uint32_t, uint32_t, uint16_t );
-  void     writeRegisterA16D32 ( uint32_t, uint32_t, uint32_t );
-  uint8_t  readRegisterA16D8   ( uint32_t, uint32_t );
-  uint16_t readRegisterA16D16  ( uint32_t, uint32_t );
-  uint32_t readRegisterA16D32  ( uint32_t, uint32_t );
-
-  // A24
-  void     writeRegisterA24D8  ( uint32_t, uint32_t, uint8_t  );
-  void     writeRegisterA24D16 ( uint32_t, uint32_t, uint16_t );
-  void     writeRegisterA24D32 ( uint32_t, uint32_t, uint32_t );
-  uint8_t  readRegisterA24D8   ( uint32_t, uint32_t );
-  uint16_t readRegisterA24D16  ( uint32_t, uint32_t );
-  uint32_t readRegisterA24D32  ( uint32_t, uint32_t );
-
-  // A32
-  void     writeRegisterA32D8  ( uint32_t, uint32_t, uint8_t  );
-  void     writeRegisterA32D16 ( uint32_t, uint32_t, uint16_t );
-  void     writeRegisterA32D32 ( uint32_t, uint32_t, uint32_t );
-  uint8_t  readRegisterA32D8   ( uint32_t, uint32_t );
-  uint16_t readRegisterA32D16  ( uint32_t, uint32_t );
-  uint32_t readRegisterA32D32  ( uint32_t, uint32_t );
+  Status   tryRead ( AddressSpace, DataWidth, uint32_t, uint32_t& );
+  Status   tryWrite( AddressSpace, DataWidth, uint32_t, uint32_t );
 
   int32_t  fifoBltRead( uint32_t, uint32_t, uint32_t, uint32_t* );
   int32_t  bltRead( uint32_t, uint32_t, uint32_t, uint32_t* );
+  Status   tryBlockRead( AddressSpace, TransferMode, uint32_t, uint32_t, uint32_t, uint32_t* );
+  Status   tryExecute( TransactionList&, size_t& );
+  bool     irqSupported() const;
+  Status   tryWaitForIrq( int, double, uint32_t*, bool& );
+  bool     reconnect();
+  bool     mapWindow( AddressSpace, uint32_t, uint32_t );
 
  private:
   VmeMasterSIS3100();
-  VmeMasterSIS3100( const char* );
-  VmeMasterSIS3100( const VmeMasterSIS3100& rother );
+  VmeMasterSIS3100( const char*, bool );
+  VmeMasterSIS3100( const VmeMasterSIS3100& );             // not implemented, the link is not copyable
+  VmeMasterSIS3100& operator=( const VmeMasterSIS3100& );  // not implemented
   virtual ~VmeMasterSIS3100();
 
+  typedef int (*bltFunc_t)( int, u_int32_t, u_int32_t*, u_int32_t, u_int32_t* );
+  Status   sisBlockRead( bltFunc_t, uint32_t, uint32_t, uint32_t* );
+  int      sisCycle( Transaction& );
+  bool     openDevice();
+  bool     mapA16();
+  void     unmapA16();
+
+  std::string _devName;    //!< file system name of the device
   int32_t  _sisHandle;
+  uint32_t _irqMask;  //!< VME interrupt levels enabled on the link
+
+  bool           _mapped;    //!< use the memory mapped VME space for announced windows
+  uint64_t       _a16Pages;  //!< announced 1 kB pages of the A16 space, one bit per page
+  volatile char *_a16Map;    //!< A16 space mapped into the process (0: not mapped)
+  size_t         _mapSize;   //!< size of the mapping
 
 }; 
 
@@ -24,6 +24,8 @@
 //_____ I N C L U D E S _______________________________________________________
 
 // ANSI C/C++ includes
+#include <algorithm>
+#include <cctype>
 #include <cerrno>
 #include <cstdio>
 #include <cstdlib>
@@ -31,7 +33,9 @@
 #include <iostream>
 
 // EPICS includes
+#include <epicsAssert.h>
 #include <epicsEvent.h>
+#include <epicsExit.h>
 #include <epicsExport.h>
 #include <epicsMutex.h>
 #include <epicsString.h>
@@ -39,6 +43,7 @@
 #include <epicsTime.h>
 #include <epicsTimer.h>
 #include <epicsTypes.h>
+#include <initHooks.h>
 #include <iocsh.h>
 
 // ASYN includes
@@ -50,21 +55,2360 @@
 #include "VmeMaster.h"
 
 //_____ D E F I N I T I O N S __________________________________________________
-typedef  std::map<int, epicsUInt32>::const_iterator  cmdIter;
+typedef union{
+  epicsFloat32 fval;
+  epicsUInt32  ival;
+} float_t;
+
+//_____ G L O B A L S __________________________________________________________
+
+//_____ L O C A L S ____________________________________________________________
+static const char *driverName = "drvAsynIsegVdsDriver";
+static const double retryMinDelay = 1.;   //!< first reconnect probe after a failure in seconds
+static const double retryMaxDelay = 60.;  //!< max. interval of reconnect probes in seconds
+static const epicsUInt32 chanAddr[ISEGVDS_NCHANNELS] = { 0x0100, 0x0140, 0x0180, 0x01c0,
+                                         0x0200, 0x0240, 0x0280, 0x02c0 };
+static const epicsUInt32 moduleWindow = 0x0400;  //!< size of the A16 window of one module
+static std::vector<drvAsynIsegVds*> drivers;      //!< all ports, their init phase ends with iocInit
+static epicsThreadPrivateId laneWriter = 0;      //!< port whose register write the thread is locking for
+
+//! Register descriptor table, indexed by parameter index
+static const isegVdsRegister isegVdsRegisters[] = {
+  // name                             type                    scope            access                                         offset  scale
+  { P_ISEGVDS_MODSTATUS_STRING,        asynParamUInt32Digital, ISEGVDS_MODULE,  ISEGVDS_READ,                                  0x0000, 1.   },
+  { P_ISEGVDS_MODEVTSTATUS_STRING,     asynParamUInt32Digital, ISEGVDS_MODULE,  ISEGVDS_READ | ISEGVDS_WRITE,                   0x0004, 1.   },
+  { P_ISEGVDS_MODEVTMASK_STRING,       asynParamUInt32Digital, ISEGVDS_MODULE,  ISEGVDS_READ | ISEGVDS_WRITE | ISEGVDS_CACHED,  0x0008, 1.   },
+  { P_ISEGVDS_MODCTRL_STRING,          asynParamUInt32Digital, ISEGVDS_MODULE,  ISEGVDS_READ | ISEGVDS_WRITE,                   0x000c, 1.   },
+  { P_ISEGVDS_MODEVTCHANSTATUS_STRING, asynParamUInt32Digital, ISEGVDS_MODULE,  ISEGVDS_READ | ISEGVDS_WRITE,                   0x0010, 1.   },
+  { P_ISEGVDS_MODEVTCHANMASK_STRING,   asynParamUInt32Digital, ISEGVDS_MODULE,  ISEGVDS_READ | ISEGVDS_WRITE | ISEGVDS_CACHED,  0x0014, 1.   },
+  { P_ISEGVDS_MODEVTGRPSTATUS_STRING,  asynParamUInt32Digital, ISEGVDS_MODULE,  ISEGVDS_READ | ISEGVDS_WRITE,                   0x0018, 1.   },
+  { P_ISEGVDS_MODEVTGRPMASK_STRING,    asynParamUInt32Digital, ISEGVDS_MODULE,  ISEGVDS_READ | ISEGVDS_WRITE | ISEGVDS_CACHED,  0x001c, 1.   },
+  { P_ISEGVDS_VRAMP_STRING,            asynParamFloat64,       ISEGVDS_MODULE,  ISEGVDS_READ | ISEGVDS_WRITE | ISEGVDS_CACHED,  0x0020, 1.   },
+  { P_ISEGVDS_CRAMP_STRING,            asynParamFloat64,       ISEGVDS_MODULE,  ISEGVDS_READ | ISEGVDS_WRITE | ISEGVDS_CACHED,  0x0024, 1.   },
+  { P_ISEGVDS_VMAX_STRING,             asynParamFloat64,       ISEGVDS_MODULE,  ISEGVDS_READ | ISEGVDS_STATIC,                  0x0028, 1.   },
+  { P_ISEGVDS_IMAX_STRING,             asynParamFloat64,       ISEGVDS_MODULE,  ISEGVDS_READ | ISEGVDS_STATIC,                  0x002c, 1.   },
+  { P_ISEGVDS_SUPPLYP5_STRING,         asynParamFloat64,       ISEGVDS_MODULE,  ISEGVDS_READ,                                  0x0040, 1.   },
+  { P_ISEGVDS_SUPPLYP12_STRING,        asynParamFloat64,       ISEGVDS_MODULE,  ISEGVDS_READ,                                  0x0044, 1.   },
+  { P_ISEGVDS_SUPPLYN12_STRING,        asynParamFloat64,       ISEGVDS_MODULE,  ISEGVDS_READ,                                  0x0048, 1.   },
+  { P_ISEGVDS_TEMPERATURE_STRING,      asynParamFloat64,       ISEGVDS_MODULE,  ISEGVDS_READ,                                  0x004c, 1.   },
+  { P_ISEGVDS_CHANSTATUS_STRING,       asynParamUInt32Digital, ISEGVDS_CHANNEL, ISEGVDS_READ,                                  0x0000, 1.   },
+  { P_ISEGVDS_CHANEVTSTATUS_STRING,    asynParamUInt32Digital, ISEGVDS_CHANNEL, ISEGVDS_READ | ISEGVDS_WRITE,                   0x0004, 1.   },
+  { P_ISEGVDS_CHANEVTMASK_STRING,      asynParamUInt32Digital, ISEGVDS_CHANNEL, ISEGVDS_READ | ISEGVDS_WRITE | ISEGVDS_CACHED,  0x0008, 1.   },
+  { P_ISEGVDS_CHANCTRL_STRING,         asynParamUInt32Digital, ISEGVDS_CHANNEL, ISEGVDS_READ | ISEGVDS_WRITE,                   0x000c, 1.   },
+  { P_ISEGVDS_CHANVSET_STRING,         asynParamFloat64,       ISEGVDS_CHANNEL, ISEGVDS_READ | ISEGVDS_WRITE | ISEGVDS_CACHED,  0x0010, 1.   },
+  { P_ISEGVDS_CHANISET_STRING,         asynParamFloat64,       ISEGVDS_CHANNEL, ISEGVDS_READ | ISEGVDS_WRITE | ISEGVDS_CACHED,  0x0014, 1.e6 }, // A -> uA
+  { P_ISEGVDS_CHANVMOM_STRING,         asynParamFloat64,       ISEGVDS_CHANNEL, ISEGVDS_READ,                                  0x0018, 1.   },
+  { P_ISEGVDS_CHANIMOM_STRING,         asynParamFloat64,       ISEGVDS_CHANNEL, ISEGVDS_READ,                                  0x001c, 1.e6 }, // A -> uA
+  { P_ISEGVDS_CHANVBOUNDS_STRING,      asynParamFloat64,       ISEGVDS_CHANNEL, ISEGVDS_READ | ISEGVDS_WRITE | ISEGVDS_CACHED,  0x0020, 1.   },
+  { P_ISEGVDS_CHANIBOUNDS_STRING,      asynParamFloat64,       ISEGVDS_CHANNEL, ISEGVDS_READ | ISEGVDS_WRITE | ISEGVDS_CACHED,  0x0024, 1.   }
+};
+static const int numIsegVdsRegisters = sizeof( isegVdsRegisters ) / sizeof( isegVdsRegisters[0] );
+
+//! Parameters following the register parameters, indexed by parameter index - NUM_ISEGVDS_REGISTERS
+static const isegVdsParameter isegVdsParameters[] = {
+  { P_ISEGVDS_VSETALL_STRING,           asynParamFloat64Array  },
+  { P_ISEGVDS_VMOMALL_STRING,           asynParamFloat64Array  },
+  { P_ISEGVDS_IMOMALL_STRING,           asynParamFloat64Array  },
+  { P_ISEGVDS_CHANSTATUSALL_STRING,     asynParamInt32Array    },
+  { P_ISEGVDS_VMOMHISTORY_STRING,       asynParamFloat64Array  },
+  { P_ISEGVDS_IMOMHISTORY_STRING,       asynParamFloat64Array  },
+  { P_ISEGVDS_HISTORYFROZEN_STRING,     asynParamInt32         },
+  { P_ISEGVDS_RAMPTARGET_STRING,        asynParamFloat64       },
+  { P_ISEGVDS_RAMPSPEED_STRING,         asynParamFloat64       },
+  { P_ISEGVDS_RAMPMAXDIFF_STRING,       asynParamFloat64       },
+  { P_ISEGVDS_RAMPRUN_STRING,           asynParamInt32         },
+  { P_ISEGVDS_MODCHANSTATUSOR_STRING,   asynParamUInt32Digital },
+  { P_ISEGVDS_MODCHANSTATUSAND_STRING,  asynParamUInt32Digital },
+  { P_ISEGVDS_MODVMOMMIN_STRING,        asynParamFloat64       },
+  { P_ISEGVDS_MODVMOMMAX_STRING,        asynParamFloat64       },
+  { P_ISEGVDS_MODVMOMMEAN_STRING,       asynParamFloat64       },
+  { P_ISEGVDS_MODVMOMSUM_STRING,        asynParamFloat64       },
+  { P_ISEGVDS_MODIMOMMIN_STRING,        asynParamFloat64       },
+  { P_ISEGVDS_MODIMOMMAX_STRING,        asynParamFloat64       },
+  { P_ISEGVDS_MODIMOMMEAN_STRING,       asynParamFloat64       },
+  { P_ISEGVDS_MODIMOMSUM_STRING,        asynParamFloat64       },
+  { P_ISEGVDS_MODCHANSON_STRING,        asynParamInt32         },
+  { P_ISEGVDS_MODCHANSRAMPING_STRING,   asynParamInt32         },
+  { P_ISEGVDS_PORTCHANSTATUSOR_STRING,  asynParamUInt32Digital },
+  { P_ISEGVDS_PORTCHANSTATUSAND_STRING, asynParamUInt32Digital },
+  { P_ISEGVDS_PORTVMOMMIN_STRING,       asynParamFloat64       },
+  { P_ISEGVDS_PORTVMOMMAX_STRING,       asynParamFloat64       },
+  { P_ISEGVDS_PORTVMOMMEAN_STRING,      asynParamFloat64       },
+  { P_ISEGVDS_PORTVMOMSUM_STRING,       asynParamFloat64       },
+  { P_ISEGVDS_PORTIMOMMIN_STRING,       asynParamFloat64       },
+  { P_ISEGVDS_PORTIMOMMAX_STRING,       asynParamFloat64       },
+  { P_ISEGVDS_PORTIMOMMEAN_STRING,      asynParamFloat64       },
+  { P_ISEGVDS_PORTIMOMSUM_STRING,       asynParamFloat64       },
+  { P_ISEGVDS_PORTCHANSON_STRING,       asynParamInt32         },
+  { P_ISEGVDS_PORTCHANSRAMPING_STRING,  asynParamInt32         },
+  { P_ISEGVDS_STATCOUNT_STRING,         asynParamInt32         },
+  { P_ISEGVDS_STATERRORS_STRING,        asynParamInt32         },
+  { P_ISEGVDS_STATMIN_STRING,           asynParamFloat64       },
+  { P_ISEGVDS_STATAVG_STRING,           asynParamFloat64       },
+  { P_ISEGVDS_STATP99_STRING,           asynParamFloat64       },
+  { P_ISEGVDS_STATMAX_STRING,           asynParamFloat64       },
+  { P_ISEGVDS_LINKCYCLES_STRING,        asynParamInt32         },
+  { P_ISEGVDS_LINKERRORS_STRING,        asynParamInt32         },
+  { P_ISEGVDS_LINKCONTENTIONS_STRING,   asynParamInt32         }
+};
+static const int numIsegVdsParameters = sizeof( isegVdsParameters ) / sizeof( isegVdsParameters[0] );
+
+//------------------------------------------------------------------------------
+//! @brief   Checksum of the register descriptor table
+//!
+//! Stored in register image files, an image taken with another table is
+//! not loaded.
+//------------------------------------------------------------------------------
+static epicsUInt32 layoutChecksum() {
+  epicsUInt32 hash = 2166136261u;  // FNV-1a
+  for( int i = 0; i < numIsegVdsRegisters; ++i ) {
+    const isegVdsRegister& reg = isegVdsRegisters[i];
+    const epicsUInt32 fields[3] = { (epicsUInt32)reg.type, (epicsUInt32)reg.scope, reg.offset };
+    for( size_t j = 0; j < 3; ++j ) {
+      hash ^= fields[j];
+      hash *= 16777619u;
+    }
+  }
+  return hash;
+}
+
+//------------------------------------------------------------------------------
+//! @brief   VME address of a register relative to the module base address
+//!
+//! @param   [in]  reg   register descriptor
+//! @param   [in]  addr  asyn address (module * ISEGVDS_NCHANNELS + channel)
+//------------------------------------------------------------------------------
+static inline epicsUInt32 registerAddress( const isegVdsRegister& reg, int addr ) {
+  return reg.offset + ( ISEGVDS_CHANNEL == reg.scope ? chanAddr[addr % ISEGVDS_NCHANNELS] : 0 );
+}
+
+//------------------------------------------------------------------------------
+//! @brief   Convert register blocks of float32 words to scaled doubles
+//!
+//! One flat loop without branches, so the compiler vectorises the widening
+//! and scaling. Words of bit field registers have a scale of 0.
+//!
+//! @param   [in]  raw     register words in host byte order
+//! @param   [in]  scale   scale factor of each word of one block
+//! @param   [in]  nwords  words per block
+//! @param   [in]  blocks  number of blocks
+//! @param   [out] values  converted words, same layout as raw
+//------------------------------------------------------------------------------
+static void convertWords( const epicsUInt32* raw, const epicsFloat64* scale, size_t nwords, size_t blocks,
+                          epicsFloat64* values ) {
+  for( size_t block = 0; block < blocks; ++block, raw += nwords, values += nwords )
+    for( size_t i = 0; i < nwords; ++i ) {
+      epicsFloat32 fval;
+      memcpy( &fval, &raw[i], sizeof( fval ) );
+      values[i] = fval * scale[i];
+    }
+}
+
+//------------------------------------------------------------------------------
+//! @brief   Absolute value of a voltage
+//------------------------------------------------------------------------------
+static inline double magnitude( double value ) {
+  return ( value < 0. ) ? -value : value;
+}
+
+//------------------------------------------------------------------------------
+//! @brief   Reset an aggregate to no channels
+//------------------------------------------------------------------------------
+static void clearAggregate( isegVdsAggregate& aggregate ) {
+  memset( &aggregate, 0, sizeof( aggregate ) );
+  aggregate.statusAnd = 0xffffffff;
+}
+
+//------------------------------------------------------------------------------
+//! @brief   Add an aggregate to another one
+//!
+//! @param   [in,out] aggregate  aggregate to extend
+//! @param   [in]     other      aggregate to add, a single channel or a module
+//------------------------------------------------------------------------------
+static void mergeAggregate( isegVdsAggregate& aggregate, const isegVdsAggregate& other ) {
+  if( !other.channels ) return;
+  if( !aggregate.channels ) {
+    aggregate = other;
+    return;
+  }
+  aggregate.channels  += other.channels;
+  aggregate.statusOr  |= other.statusOr;
+  aggregate.statusAnd &= other.statusAnd;
+  aggregate.vmomMin    = std::min( aggregate.vmomMin, other.vmomMin );
+  aggregate.vmomMax    = std::max( aggregate.vmomMax, other.vmomMax );
+  aggregate.vmomSum   += other.vmomSum;
+  aggregate.imomMin    = std::min( aggregate.imomMin, other.imomMin );
+  aggregate.imomMax    = std::max( aggregate.imomMax, other.imomMax );
+  aggregate.imomSum   += other.imomSum;
+  aggregate.on        += other.on;
+  aggregate.ramping   += other.ramping;
+}
+
+//_____ F U N C T I O N S ______________________________________________________
+
+//------------------------------------------------------------------------------
+//! @brief   C wrapper to start the background poller of a drvAsynIsegVds
+//!
+//! @param   [in]  drvPvt  pointer to the drvAsynIsegVds instance
+//------------------------------------------------------------------------------
+static void pollerThreadC( void *drvPvt ) {
+  drvAsynIsegVds *pPvt = (drvAsynIsegVds *)drvPvt;
+  pPvt->pollerThread();
+}
+
+//------------------------------------------------------------------------------
+//! @brief   C wrapper to start the event handler of a drvAsynIsegVds
+//!
+//! @param   [in]  drvPvt  pointer to the drvAsynIsegVds instance
+//------------------------------------------------------------------------------
+static void eventThreadC( void *drvPvt ) {
+  drvAsynIsegVds *pPvt = (drvAsynIsegVds *)drvPvt;
+  pPvt->eventThread();
+}
+
+//------------------------------------------------------------------------------
+//! @brief   Seed the parameters of all ports before the records are
+//!          initialised and end their init phase once the IOC is running
+//!
+//! Seeding waits for iocInit, so a register image file configured after
+//! the port is applied. The poller is already running at this time, the
+//! values of the file replace those of its polls until the next poll of
+//! each module.
+//------------------------------------------------------------------------------
+static void initHookC( initHookState state ) {
+  if( initHookAfterInitDrvSup == state )
+    for( size_t i = 0; i < drivers.size(); ++i ) drivers[i]->seedParameters();
+  if( initHookAfterIocRunning == state )
+    for( size_t i = 0; i < drivers.size(); ++i ) drivers[i]->endInitPhase();
+}
+
+//------------------------------------------------------------------------------
+//! @brief   Find a configured drvAsynIsegVds by its port name
+//!
+//! Only ports of this class are searched, so the name of another asyn port
+//! is never cast to a drvAsynIsegVds. Ports whose constructor aborted are
+//! not in the list.
+//!
+//! @param   [in]  portName  name of the asyn port
+//! @param   [in]  caller    name of the iocsh function for the error message
+//!
+//! @return  the drvAsynIsegVds instance or 0 if there is none of this name
+//------------------------------------------------------------------------------
+static drvAsynIsegVds* findDriver( const char *portName, const char *caller ) {
+  for( size_t i = 0; portName && i < drivers.size(); ++i )
+    if( 0 == strcmp( drivers[i]->portName, portName ) ) return drivers[i];
+  fprintf( stderr, "%s: Port %s not found or not configured\n", caller, portName ? portName : "(null)" );
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+//! @brief   C wrapper to flush the coalesced writes of a drvAsynIsegVds
+//!
+//! @param   [in]  drvPvt  pointer to the drvAsynIsegVds instance
+//------------------------------------------------------------------------------
+static void flushWritesC( void *drvPvt ) {
+  drvAsynIsegVds *pPvt = (drvAsynIsegVds *)drvPvt;
+  pPvt->flushWrites();
+}
+
+//------------------------------------------------------------------------------
+//! @brief   C wrappers of the interposed write functions of a drvAsynIsegVds
+//!
+//! @param   [in]  drvPvt  pointer to the drvAsynIsegVds instance
+//------------------------------------------------------------------------------
+static asynStatus writeFloat64C( void *drvPvt, asynUser *pasynUser, epicsFloat64 value ) {
+  drvAsynIsegVds *pPvt = static_cast<drvAsynIsegVds *>( (asynPortDriver *)drvPvt );
+  return pPvt->laneWrite( pasynUser, value );
+}
+
+static asynStatus writeUInt32DigitalC( void *drvPvt, asynUser *pasynUser, epicsUInt32 value, epicsUInt32 mask ) {
+  drvAsynIsegVds *pPvt = static_cast<drvAsynIsegVds *>( (asynPortDriver *)drvPvt );
+  return pPvt->laneWrite( pasynUser, value, mask );
+}
+
+static asynStatus writeFloat64ArrayC( void *drvPvt, asynUser *pasynUser, epicsFloat64 *value, size_t nElements ) {
+  drvAsynIsegVds *pPvt = static_cast<drvAsynIsegVds *>( (asynPortDriver *)drvPvt );
+  return pPvt->laneWrite( pasynUser, value, nElements );
+}
+
+//------------------------------------------------------------------------------
+//! @brief   C wrapper to save the register image of a drvAsynIsegVds on exit
+//!
+//! @param   [in]  drvPvt  pointer to the drvAsynIsegVds instance
+//------------------------------------------------------------------------------
+static void saveImageC( void *drvPvt ) {
+  drvAsynIsegVds *pPvt = (drvAsynIsegVds *)drvPvt;
+  pPvt->saveImage();
+}
+
+//------------------------------------------------------------------------------
+//! @brief   Read a contiguous block of 32 bit registers of the module
+//!
+//! Uses a block transfer if the VME master supports it for the A16 space,
+//! otherwise the VME master falls back to single cycles.
+//!
+//! @param   [in]  module      module number
+//! @param   [in]  subAddress  address of first register relative to base address
+//! @param   [in]  nwords      number of 32 bit words to read
+//! @param   [out] buffer      buffer receiving the register contents
+//!
+//! @return  status of the VME transfer
+//------------------------------------------------------------------------------
+VmeMaster::Status drvAsynIsegVds::readBlock( size_t module, epicsUInt32 subAddress, epicsUInt32 nwords, epicsUInt32* buffer ) {
+  return _vme->tryBlockRead( VmeMaster::A16, VmeMaster::BLT32, _bases[module], subAddress, nwords, buffer );
+}
+
+//------------------------------------------------------------------------------
+//! @brief   Read the register blocks of all channels of a module
+//!
+//! In snapshot mode the channel blocks are read as one transaction list,
+//! so the link stays locked for all channels, and the time is taken right
+//! after it from the configured time source. A16 has no block transfer,
+//! snapshot mode is only enabled if the VME master maps the A16 windows,
+//! so the list is a burst of memory reads. The gaps between the channel
+//! blocks are not read. Otherwise each channel block is read separately
+//! and the time is taken before the first transfer.
+//!
+//! @param   [in]  module    module number
+//! @param   [out] chanData  buffer for the register blocks of all channels
+//! @param   [out] snapshot  time of the transfer
+//!
+//! @return  status of the first failed VME transfer
+//------------------------------------------------------------------------------
+VmeMaster::Status drvAsynIsegVds::readChannelBlocks( size_t module, epicsUInt32* chanData, epicsTimeStamp& snapshot ) {
+  const epicsUInt32 chanWords = _blockWords[ISEGVDS_CHANNEL];
+  VmeMaster::Status status = VmeMaster::SUCCESS;
+
+  if( !_snapshotMode ) {
+    epicsTimeGetCurrent( &snapshot );
+    for( int ch = 0; ch < ISEGVDS_NCHANNELS && VmeMaster::SUCCESS == status; ++ch )
+      status = readBlock( module, chanAddr[ch], chanWords, chanData + ch * chanWords );
+    return status;
+  }
+
+  size_t i = 0;
+  for( int ch = 0; ch < ISEGVDS_NCHANNELS; ++ch )
+    for( epicsUInt32 word = 0; word < chanWords; ++word )
+      _snapshotList[i++].address = _bases[module] + chanAddr[ch] + 4 * word;
+  size_t executed;
+  status = _vme->tryExecute( _snapshotList, executed );
+  if( epicsTimeOK != epicsTimeGetEvent( &snapshot, _timeEvent ) ) epicsTimeGetCurrent( &snapshot );
+  if( status ) return status;
+
+  for( i = 0; i < _snapshotList.size(); ++i ) chanData[i] = _snapshotList[i].value;
+  _snapshotTime[module] = snapshot;
+  return status;
+}
+
+//------------------------------------------------------------------------------
+//! @brief   Check if a read can be served from the last snapshot
+//!
+//! In snapshot mode the read-only channel registers (status and measured
+//! values) are returned from the parameter library with the time of the
+//! snapshot, so values of different channels are consistent.
+//!
+//! @param   [in]  addr      asyn address
+//! @param   [in]  function  index of the parameter
+//! @param   [out] snapshot  time of the snapshot
+//------------------------------------------------------------------------------
+bool drvAsynIsegVds::fromSnapshot( int addr, int function, epicsTimeStamp& snapshot ) const {
+  const isegVdsRegister& reg = isegVdsRegisters[function];
+  if( !_snapshotMode || ISEGVDS_CHANNEL != reg.scope || ( reg.access & ISEGVDS_WRITE ) ) return false;
+  snapshot = _snapshotTime[addr / ISEGVDS_NCHANNELS];
+  return 0 != snapshot.secPastEpoch;
+}
+
+//------------------------------------------------------------------------------
+//! @brief   Write a 32 bit register, optionally followed by a verify read
+//!
+//! Write and verify read are submitted as one transaction list, so they
+//! are not separated by accesses of other threads to the VME link.
+//!
+//! @param   [in]  addr     asyn address
+//! @param   [in]  vmeAddr  address of the register relative to the module base address
+//! @param   [in]  value    value to write
+//! @param   [in]  verify   read back the register after writing
+//! @param   [out] readback content of the register after the write (value if verify is false)
+//!
+//! @return  status of the VME transfer
+//------------------------------------------------------------------------------
+VmeMaster::Status drvAsynIsegVds::writeRegister( int addr, epicsUInt32 vmeAddr, epicsUInt32 value, bool verify,
+                                                 epicsUInt32& readback ) {
+  const epicsUInt32 address = _bases[addr / ISEGVDS_NCHANNELS] + vmeAddr;
+  VmeMaster::TransactionList list;
+  list.push_back( VmeMaster::writeCycle( VmeMaster::A16, VmeMaster::WIDTH32, address, value ) );
+  if( verify ) list.push_back( VmeMaster::readCycle( VmeMaster::A16, VmeMaster::WIDTH32, address ) );
+  size_t executed;
+  VmeMaster::Status status = _vme->tryExecute( list, executed );
+  if( VmeMaster::SUCCESS == status ) readback = list.back().value;
+  return status;
+}
+
+//------------------------------------------------------------------------------
+//! @brief   Convert raw content of a float register to engineering units
+//!
+//! Float registers are reinterpreted as IEEE754 single precision values
+//! and multiplied with the scale factor of the register descriptor.
+//------------------------------------------------------------------------------
+epicsFloat64 drvAsynIsegVds::toDouble( int function, epicsUInt32 vmeData ) const {
+  float_t data;
+  data.ival = vmeData;
+  return data.fval * isegVdsRegisters[function].scale;
+}
+
+//------------------------------------------------------------------------------
+//! @brief   Check if the value in the parameter library is recent enough
+//!          to be returned without VME access
+//!
+//! Only registers flagged ISEGVDS_CACHED in the descriptor table are
+//! served from the cache. Registers flagged ISEGVDS_STATIC are served
+//! once read, all registers while iocInit is running. A time stamp with
+//! secPastEpoch == 0 marks an unconfirmed value.
+//------------------------------------------------------------------------------
+bool drvAsynIsegVds::isCacheValid( int addr, int function ) const {
+  const int access = isegVdsRegisters[function].access;
+  const epicsTimeStamp& confirmed = _cacheTime[addr][function];
+  if( 0 == confirmed.secPastEpoch ) return false;
+  if( _initPhase || ( access & ISEGVDS_STATIC ) ) return true;
+  if( _cacheMaxAge <= 0. || !( access & ISEGVDS_CACHED ) ) return false;
+
+  epicsTimeStamp now;
+  epicsTimeGetCurrent( &now );
+  return ( epicsTimeDiffInSeconds( &now, &confirmed ) < _cacheMaxAge );
+}
+
+//------------------------------------------------------------------------------
+//! @brief   Mark value in parameter library as confirmed by the hardware
+//!
+//! Also clears the status of a value loaded from the register image file.
+//------------------------------------------------------------------------------
+void drvAsynIsegVds::confirmCache( int addr, int function, const epicsTimeStamp& when ) {
+  const int access = isegVdsRegisters[function].access;
+  setParamStatus( addr, function, asynSuccess );
+  if( _initPhase || ( access & ISEGVDS_STATIC ) || ( _cacheMaxAge > 0. && ( access & ISEGVDS_CACHED ) ) )
+    _cacheTime[addr][function] = when;
+}
+
+//------------------------------------------------------------------------------
+//! @brief   Mark value in parameter library as confirmed by the hardware now
+//------------------------------------------------------------------------------
+void drvAsynIsegVds::confirmCache( int addr, int function ) {
+  epicsTimeStamp now;
+  epicsTimeGetCurrent( &now );
+  confirmCache( addr, function, now );
+}
+
+//------------------------------------------------------------------------------
+//! @brief   Set max. age of cached setpoints
+//!
+//! @param   [in]  maxAge  time in seconds after which a cached value is read
+//!                        again from the hardware (<= 0: caching disabled)
+//------------------------------------------------------------------------------
+void drvAsynIsegVds::setCacheMaxAge( double maxAge ) {
+  lock();
+  _cacheMaxAge = maxAge;
+  // values seeded during iocInit and static registers stay confirmed
+  for( size_t i = 0; i < _cacheTime.size() && !_initPhase; ++i )
+    for( int function = 0; function < NUM_ISEGVDS_REGISTERS; ++function )
+      if( !( isegVdsRegisters[function].access & ISEGVDS_STATIC ) ) _cacheTime[i][function].secPastEpoch = 0;
+  unlock();
+}
+
+//------------------------------------------------------------------------------
+//! @brief   Read the register images of all modules once
+//!
+//! Seeds all module and channel parameters and the shadow copies with one
+//! full poll per module, so records initialise from the parameter library
+//! without VME access of their own. Modules which do not answer are
+//! disconnected and probed by the poller later.
+//! If a register image file is configured, its values are published
+//! first and the settings changed since it was saved are reported. The
+//! poller may have read the modules before, the shadow copies of the
+//! modules in the file are dropped so the next poll replaces all its values.
+//------------------------------------------------------------------------------
+void drvAsynIsegVds::seedParameters() {
+  static const char *functionName = "seedParameters";
+  RegisterImage image;
+  lock();
+  loadImage( image );
+  unlock();
+  if( !_vme->isLinkUp() ) return;
+
+  std::vector<epicsUInt32> modData( _blockWords[ISEGVDS_MODULE] );
+  std::vector<epicsUInt32> chanData( _blockWords[ISEGVDS_CHANNEL] * ISEGVDS_NCHANNELS );
+  lock();
+  for( size_t module = 0; module < _bases.size(); ++module ) {
+    epicsTimeStamp start;
+    epicsTimeGetCurrent( &start );
+    VmeMaster::Status status = pollModule( module, &modData[0], &chanData[0] );
+    if( VmeMaster::SUCCESS == status ) {
+      _latency[ISEGVDS_STAT_POLL].add( start );
+      unsigned changed = compareImage( image, module, &modData[0], &chanData[0] );
+      if( changed )
+        fprintf( stderr, "%s:%s: module %lu (BA 0x%04x) of %s: %u settings changed since %s was saved\n",
+                 driverName, functionName, (unsigned long)module, _bases[module], _deviceName,
+                 changed, _imageFile );
+      // the poller starts with the fast poll
+      epicsTimeAddSeconds( &start, _slowPeriod );
+      _nextFullPoll[module] = start;
+      continue;
+    }
+    _latency[ISEGVDS_STAT_POLL].addError();
+    fprintf( stderr, "%s:%s: module %lu (BA 0x%04x) of %s: %s\n",
+             driverName, functionName, (unsigned long)module, _bases[module], _deviceName,
+             VmeMaster::statusString( status ) );
+    if( VmeMaster::LINK_DOWN == status ) break;
+    setModuleConnected( module, false );
+  }
+  unlock();
+}
+
+//------------------------------------------------------------------------------
+//! @brief   Publish the values of the register image file
+//!
+//! Modules are matched by their base address. The values are not
+//! confirmed, reads still go to the hardware and the parameters carry
+//! asynDisconnected, so records show them with an INVALID alarm, until
+//! the next poll of the module replaces them.
+//!
+//! @param   [out] image  content of the file, empty if there is none or it
+//!                       does not match the register layout
+//------------------------------------------------------------------------------
+void drvAsynIsegVds::loadImage( RegisterImage& image ) {
+  static const char *functionName = "loadImage";
+  if( !_imageFile ) return;
+
+  std::string error;
+  RegisterImage layout;
+  layout.init( layoutChecksum(), 0, ISEGVDS_NCHANNELS, _blockWords[ISEGVDS_MODULE], _blockWords[ISEGVDS_CHANNEL],
+               chanAddr[0], chanAddr[1] - chanAddr[0] );
+  if( !image.read( _imageFile, error ) || !layout.compatible( image ) ) {
+    fprintf( stderr, "%s:%s: %s not loaded: %s\n", driverName, functionName, _imageFile,
+             error.empty() ? "other register layout" : error.c_str() );
+    image = layout;
+    return;
+  }
+
+  epicsTimeStamp saved = { image.header().secPastEpoch, image.header().nsec };
+  beginCycle( saved );
+  for( size_t module = 0; module < _bases.size(); ++module ) {
+    int index = image.findModule( _bases[module] );
+    if( index < 0 || !image.valid( index ) ) continue;
+    // the poller may have read the module already, its next poll has to
+    // replace and confirm all values of the file
+    forgetModule( module );
+    const int modAddr = module * ISEGVDS_NCHANNELS;
+    const std::vector<int>& modParams = _blockParams[ISEGVDS_MODULE];
+    for( size_t i = 0; i < modParams.size(); ++i ) {
+      epicsUInt32 word = image.moduleBlock( index )[isegVdsRegisters[modParams[i]].offset / 4];
+      updateParam( modAddr, modParams[i], word, toDouble( modParams[i], word ), true );
+      setParamStatus( modAddr, modParams[i], asynDisconnected );
+    }
+    const std::vector<int>& chanParams = _blockParams[ISEGVDS_CHANNEL];
+    for( int ch = 0; ch < ISEGVDS_NCHANNELS; ++ch ) {
+      for( size_t i = 0; i < chanParams.size(); ++i ) {
+        epicsUInt32 word = image.chanBlock( index, ch )[isegVdsRegisters[chanParams[i]].offset / 4];
+        updateParam( modAddr + ch, chanParams[i], word, toDouble( chanParams[i], word ), true );
+        setParamStatus( modAddr + ch, chanParams[i], asynDisconnected );
+      }
+      markDirty( modAddr + ch );
+    }
+  }
+  endCycle();
+}
+
+//------------------------------------------------------------------------------
+//! @brief   Count the settings of a module which differ from the register
+//!          image file
+//!
+//! @param   [in]  image     content of the file
+//! @param   [in]  module    module number
+//! @param   [in]  modData   module register block read from the bus
+//! @param   [in]  chanData  channel register blocks read from the bus
+//------------------------------------------------------------------------------
+unsigned drvAsynIsegVds::compareImage( const RegisterImage& image, size_t module, const epicsUInt32* modData,
+                                       const epicsUInt32* chanData ) const {
+  int index = image.findModule( _bases[module] );
+  if( index < 0 || !image.valid( index ) ) return 0;
+
+  unsigned changed = 0;
+  const std::vector<int>& modParams = _blockParams[ISEGVDS_MODULE];
+  for( size_t i = 0; i < modParams.size(); ++i ) {
+    const isegVdsRegister& reg = isegVdsRegisters[modParams[i]];
+    if( ( reg.access & ISEGVDS_CACHED ) && modData[reg.offset / 4] != image.moduleBlock( index )[reg.offset / 4] )
+      ++changed;
+  }
+  const std::vector<int>& chanParams = _blockParams[ISEGVDS_CHANNEL];
+  for( int ch = 0; ch < ISEGVDS_NCHANNELS; ++ch )
+    for( size_t i = 0; i < chanParams.size(); ++i ) {
+      const isegVdsRegister& reg = isegVdsRegisters[chanParams[i]];
+      const epicsUInt32 idx = ch * _blockWords[ISEGVDS_CHANNEL] + reg.offset / 4;
+      if( ( reg.access & ISEGVDS_CACHED ) && chanData[idx] != image.chanBlock( index, ch )[reg.offset / 4] )
+        ++changed;
+    }
+  return changed;
+}
+
+//------------------------------------------------------------------------------
+//! @brief   Write the shadow copies of all modules to the register image file
+//!
+//! The shadow copies are taken under the port lock, the file is written
+//! after releasing it.
+//------------------------------------------------------------------------------
+void drvAsynIsegVds::saveImage() {
+  static const char *functionName = "saveImage";
+  if( !_imageFile ) return;
+
+  RegisterImage image;
+  image.init( layoutChecksum(), _bases.size(), ISEGVDS_NCHANNELS, _blockWords[ISEGVDS_MODULE],
+              _blockWords[ISEGVDS_CHANNEL], chanAddr[0], chanAddr[1] - chanAddr[0] );
+  epicsTimeStamp now;
+  epicsTimeGetCurrent( &now );
+  image.setTime( now.secPastEpoch, now.nsec );
+
+  lock();
+  for( size_t module = 0; module < _bases.size(); ++module ) {
+    const int modAddr = module * ISEGVDS_NCHANNELS;
+    image.base( module ) = _bases[module];
+    if( _modImage[module].empty() ) continue;
+    bool valid = true;
+    for( int ch = 0; ch < ISEGVDS_NCHANNELS; ++ch ) valid = valid && !_chanImage[modAddr + ch].empty();
+    if( !valid ) continue;
+    image.valid( module ) = 1;
+    std::copy( _modImage[module].begin(), _modImage[module].end(), image.moduleBlock( module ) );
+    for( int ch = 0; ch < ISEGVDS_NCHANNELS; ++ch )
+      std::copy( _chanImage[modAddr + ch].begin(), _chanImage[modAddr + ch].end(), image.chanBlock( module, ch ) );
+  }
+  unlock();
+
+  std::string error;
+  epicsMutexMustLock( _imageLock );
+  if( !image.write( _imageFile, error ) )
+    fprintf( stderr, "%s:%s: Could not write %s: %s\n", driverName, functionName, _imageFile, error.c_str() );
+  epicsMutexUnlock( _imageLock );
+}
+
+//------------------------------------------------------------------------------
+//! @brief   Keep the register images of all modules in a file
+//!
+//! The file is read by seedParameters() at iocInit and written in the
+//! background and on exit.
+//!
+//! @param   [in]  path    name of the file
+//! @param   [in]  period  interval of saving in seconds (0: on exit only)
+//!
+//! @return  asynError if a file is already set or the period is negative
+//------------------------------------------------------------------------------
+asynStatus drvAsynIsegVds::setImageFile( const char *path, double period ) {
+  if( _imageFile || !path || !path[0] || period < 0. ) return asynError;
+
+  lock();
+  _imageFile   = epicsStrDup( path );
+  _imagePeriod = period;
+  epicsTimeGetCurrent( &_nextImage );
+  epicsTimeAddSeconds( &_nextImage, _imagePeriod );
+  unlock();
+  epicsAtExit( saveImageC, this );
+  return asynSuccess;
+}
+
+//------------------------------------------------------------------------------
+//! @brief   End of iocInit, reads go to the hardware again
+//!
+//! Called by the init hook at initHookAfterIocRunning. The values seeded
+//! by seedParameters() stay confirmed for cached and static registers.
+//------------------------------------------------------------------------------
+void drvAsynIsegVds::endInitPhase() {
+  lock();
+  _initPhase = false;
+  unlock();
+}
+
+//------------------------------------------------------------------------------
+//! @brief   Store the raw content of a register in the parameter library
+//!
+//! @param   [in]  addr      asyn address
+//! @param   [in]  function  index of the parameter
+//! @param   [in]  vmeData   raw register content
+//------------------------------------------------------------------------------
+void drvAsynIsegVds::updateParam( int addr, int function, epicsUInt32 vmeData ) {
+  updateParam( addr, function, vmeData, toDouble( function, vmeData ) );
+}
+
+//------------------------------------------------------------------------------
+//! @brief   Store a register in the parameter library
+//!
+//! @param   [in]  addr      asyn address
+//! @param   [in]  function  index of the parameter
+//! @param   [in]  vmeData   raw register content
+//! @param   [in]  value     register content converted by convertBlocks()
+//! @param   [in]  cold      the shadow copy was empty, all bits are called back
+//------------------------------------------------------------------------------
+void drvAsynIsegVds::updateParam( int addr, int function, epicsUInt32 vmeData, epicsFloat64 value, bool cold ) {
+  if( asynParamUInt32Digital == isegVdsRegisters[function].type )
+    setBits( addr, function, vmeData, 0xffffffff, cold );
+  else
+    setDoubleParam( addr, function, value );
+}
+
+//------------------------------------------------------------------------------
+//! @brief   Store a bit field parameter, only changed bits are called back
+//!
+//! The interrupt mask is the XOR of the new and the previous word, so
+//! asyn clients registered with a single bit mask (e.g. bi records on
+//! ChannelStatus with asynMask 0x2000) only process if their bit changed.
+//! The previous word is meaningless before the first read of the register,
+//! then all bits in mask are called back, so bits reading 0 get a value too.
+//!
+//! @param   [in]  addr      asyn address
+//! @param   [in]  function  index of the parameter
+//! @param   [in]  value     new content of the bits in mask
+//! @param   [in]  mask      bits to set
+//! @param   [in]  all       call back all bits in mask, not only the changed ones
+//------------------------------------------------------------------------------
+asynStatus drvAsynIsegVds::setBits( int addr, int function, epicsUInt32 value, epicsUInt32 mask, bool all ) {
+  epicsUInt32 previous = 0;
+  getUIntDigitalParam( addr, function, &previous, 0xffffffff );
+  return setUIntDigitalParam( addr, function, value, mask, all ? mask : ( previous ^ value ) & mask );
+}
+
+//------------------------------------------------------------------------------
+//! @brief   Convert register blocks to engineering units in one pass
+//!
+//! @param   [in]  scope   ISEGVDS_MODULE or ISEGVDS_CHANNEL
+//! @param   [in]  raw     consecutive register blocks
+//! @param   [in]  blocks  number of blocks
+//! @param   [out] values  converted words, same layout as raw
+//------------------------------------------------------------------------------
+void drvAsynIsegVds::convertBlocks( int scope, const epicsUInt32* raw, size_t blocks, epicsFloat64* values ) const {
+  convertWords( raw, &_blockScale[scope][0], _blockWords[scope], blocks, values );
+}
+
+//------------------------------------------------------------------------------
+//! @brief   Check if the module reports a measured value inside its bounds
+//!
+//! The module compares VoltageMeasure and CurrentMeasure with the setpoint
+//! and flags them in ChannelStatus once they leave the window set by
+//! VoltageBounds and CurrentBounds. Changes inside the window are noise
+//! and not published, the value is published once more when it enters
+//! the window.
+//!
+//! @param   [in]  function    index of the parameter
+//! @param   [in]  vmeData     snapshot of the channel register block
+//! @param   [in]  lastStatus  ChannelStatus of the previous snapshot
+//!
+//! @return  false for other parameters or if the bounds are 0
+//------------------------------------------------------------------------------
+bool drvAsynIsegVds::insideBounds( int function, const epicsUInt32* vmeData, epicsUInt32 lastStatus ) const {
+  int bounds = 0;
+  epicsUInt32 bit = 0;
+  if( P_ChanVmom == function ) {
+    bounds = P_ChanVBounds;
+    bit    = ISEGVDS_CHANSTATUS_VBOUNDS;
+  } else if( P_ChanImom == function ) {
+    bounds = P_ChanIBounds;
+    bit    = ISEGVDS_CHANSTATUS_CBOUNDS;
+  } else {
+    return false;
+  }
+
+  const epicsUInt32 status = vmeData[isegVdsRegisters[P_ChanStatus].offset / 4];
+  if( ( status | lastStatus ) & bit ) return false;
+  return toDouble( bounds, vmeData[isegVdsRegisters[bounds].offset / 4] ) > 0.;
+}
+
+//------------------------------------------------------------------------------
+//! @brief   Compare a snapshot of a register block with its shadow copy
+//!
+//! Only parameters whose register content differs from the shadow copy are
+//! updated. Float parameters with a deadband are only updated if the new
+//! value differs by more than the deadband from the value in the parameter
+//! library. Their shadow word is kept, so slow drifts are still published
+//! once they accumulate to the deadband. Measured values inside the
+//! bounds window of the module are not updated either, see insideBounds().
+//!
+//! @param   [in]     addr     asyn address
+//! @param   [in]     scope    ISEGVDS_MODULE or ISEGVDS_CHANNEL
+//! @param   [in]     vmeData  snapshot of the register block
+//! @param   [in]     values   snapshot converted by convertBlocks()
+//! @param   [in,out] image    shadow copy of the register block,
+//!                            empty if it has not been filled yet
+//------------------------------------------------------------------------------
+void drvAsynIsegVds::updateBlock( int addr, int scope, const epicsUInt32* vmeData, const epicsFloat64* values,
+                                  std::vector<epicsUInt32>& image ) {
+  bool valid = !image.empty();
+  if( !valid ) image.assign( _blockWords[scope], 0 );
+  const epicsUInt32 lastStatus = image[isegVdsRegisters[P_ChanStatus].offset / 4];
+
+  epicsTimeStamp now;
+  epicsTimeGetCurrent( &now );
+
+  const std::vector<int>& params = _blockParams[scope];
+  for( size_t i = 0; i < params.size(); ++i ) {
+    int function = params[i];
+    epicsUInt32 idx = isegVdsRegisters[function].offset / 4;
+    confirmCache( addr, function, now );
+    if( valid && !( vmeData[idx] ^ image[idx] ) ) continue;
+    if( valid && ISEGVDS_CHANNEL == scope && insideBounds( function, vmeData, lastStatus ) ) continue;
+
+    double deadband = _deadbands[function];
+    if( valid && deadband > 0. ) {
+      epicsFloat64 oldValue = 0.;
+      getDoubleParam( addr, function, &oldValue );
+      epicsFloat64 diff = values[idx] - oldValue;
+      if( diff < deadband && -diff < deadband ) continue;
+    }
+
+    image[idx] = vmeData[idx];
+    updateParam( addr, function, vmeData[idx], values[idx], !valid );
+  }
+}
+
+//------------------------------------------------------------------------------
+//! @brief   Set the write coalescing window of a float parameter
+//!
+//! Writes to the parameter are held back for the window, a later write to
+//! the same register replaces the held value. All registers held are
+//! written and read back in one transaction list per module.
+//!
+//! @param   [in]  paramName  drvInfo string of the parameter
+//! @param   [in]  window     window in seconds (<= 0: write immediately)
+//!
+//! @return  asynError if parameter does not exist or is no writable float parameter
+//------------------------------------------------------------------------------
+asynStatus drvAsynIsegVds::setWriteWindow( const char *paramName, double window ) {
+  int function = 0;
+  if( asynSuccess != findParam( paramName, &function ) ||
+      function >= NUM_ISEGVDS_REGISTERS ||
+      asynParamFloat64 != isegVdsRegisters[function].type ||
+      !( isegVdsRegisters[function].access & ISEGVDS_WRITE ) )
+    return asynError;
+
+  lock();
+  if( !_writeTimer ) {
+    _writeTimer = epicsTimerQueueCreateTimer( epicsTimerQueueAllocate( 1, epicsThreadPriorityScanHigh ),
+                                              flushWritesC, this );
+    _pendingValue.assign( _chanAddrs * NUM_ISEGVDS_REGISTERS, 0 );
+    _writePending.assign( _chanAddrs * NUM_ISEGVDS_REGISTERS, false );
+  }
+  _writeWindows[function] = ( window > 0. ) ? window : 0.;
+  unlock();
+  return asynSuccess;
+}
+
+//------------------------------------------------------------------------------
+//! @brief   Hold back a write for the coalescing window of its parameter
+//!
+//! The held back writes are flushed together at the end of the shortest
+//! window among them.
+//!
+//! @param   [in]  addr      asyn address
+//! @param   [in]  function  index of the parameter
+//! @param   [in]  vmeData   raw register content to write
+//------------------------------------------------------------------------------
+void drvAsynIsegVds::queueWrite( int addr, int function, epicsUInt32 vmeData ) {
+  const size_t idx = addr * NUM_ISEGVDS_REGISTERS + function;
+  _cacheTime[addr][function].secPastEpoch = 0;
+  _pendingValue[idx] = vmeData;
+  if( _writePending[idx] ) {
+    ++_writesCoalesced;
+    return;
+  }
+  _writePending[idx] = true;
+  epicsTimeStamp due;
+  epicsTimeGetCurrent( &due );
+  epicsTimeAddSeconds( &due, _writeWindows[function] );
+  if( _pendingWrites.empty() || epicsTimeLessThan( &due, &_writeDue ) ) {
+    _writeDue = due;
+    epicsTimerStartDelay( _writeTimer, _writeWindows[function] );
+  }
+  _pendingWrites.push_back( std::make_pair( addr, function ) );
+}
+
+//------------------------------------------------------------------------------
+//! @brief   Write all held back registers and read them back
+//!
+//! Called by the write timer at the end of the coalescing window. The
+//! registers of one module are written and verified in one transaction
+//! list, the readbacks are published in one update cycle. After a failed
+//! transfer the registers not written show their content known before
+//! the write again, the written ones without readback the value written.
+//! Writes to modules which do not answer fail without VME access.
+//------------------------------------------------------------------------------
+void drvAsynIsegVds::flushWrites() {
+  static const char *functionName = "flushWrites";
+  lock();
+  std::vector< std::pair<int, int> > writes;
+  writes.swap( _pendingWrites );
+
+  epicsTimeStamp start;
+  epicsTimeGetCurrent( &start );
+  beginCycle( start );
+  for( size_t module = 0; module < _bases.size(); ++module ) {
+    std::vector< std::pair<int, int> > batch;
+    VmeMaster::TransactionList list;
+    for( size_t i = 0; i < writes.size(); ++i ) {
+      const int addr = writes[i].first;
+      if( addr / ISEGVDS_NCHANNELS != (int)module ) continue;
+      const int function = writes[i].second;
+      const epicsUInt32 address = _bases[module] + registerAddress( isegVdsRegisters[function], addr );
+      list.push_back( VmeMaster::writeCycle( VmeMaster::A16, VmeMaster::WIDTH32, address,
+                                             _pendingValue[addr * NUM_ISEGVDS_REGISTERS + function] ) );
+      batch.push_back( writes[i] );
+    }
+    if( batch.empty() ) continue;
+    for( size_t i = 0; i < batch.size(); ++i )
+      list.push_back( VmeMaster::readCycle( VmeMaster::A16, VmeMaster::WIDTH32, list[i].address ) );
+
+    size_t executed = 0;
+    const bool up = !_linkDown && _moduleUp[module];
+    VmeMaster::Status status = up ? _vme->tryExecute( list, executed ) : VmeMaster::LINK_DOWN;
+    if( status ) {
+      _latency[ISEGVDS_STAT_WRITE].addError();
+      asynPrint( pasynUserSelf, ASYN_TRACE_ERROR,
+                 "%s:%s:%s: module %lu (BA 0x%04x): %lu of %lu coalesced writes failed: %s\n",
+                 driverName, _deviceName, functionName, (unsigned long)module, _bases[module],
+                 (unsigned long)( executed < batch.size() ? batch.size() - executed : 0 ),
+                 (unsigned long)batch.size(),
+                 up ? VmeMaster::statusString( status ) : "module not responding" );
+    } else {
+      _latency[ISEGVDS_STAT_WRITE].add( start );
+    }
+
+    for( size_t i = 0; i < batch.size(); ++i ) {
+      const int addr = batch[i].first;
+      const int function = batch[i].second;
+      const size_t idx = addr * NUM_ISEGVDS_REGISTERS + function;
+      std::vector<epicsUInt32>& image = ( ISEGVDS_CHANNEL == isegVdsRegisters[function].scope ) ?
+                                        _chanImage[addr] : _modImage[module];
+      _writePending[idx] = false;
+      if( i >= executed ) {
+        // not written, show the register content known before the write again
+        if( !image.empty() ) updateParam( addr, function, image[isegVdsRegisters[function].offset / 4] );
+      } else if( batch.size() + i >= executed ) {
+        // written without readback, the next poll confirms it
+        updateParam( addr, function, _pendingValue[idx] );
+      } else {
+        const epicsUInt32 readback = list[batch.size() + i].value;
+        if( readback == _pendingValue[idx] ) confirmCache( addr, function );
+        storeWord( addr, function, readback, image );
+      }
+      markDirty( addr );
+    }
+  }
+  endCycle();
+  unlock();
+}
+
+//------------------------------------------------------------------------------
+//! @brief   Set the deadband of a float parameter used by the poller
+//!
+//! @param   [in]  paramName  drvInfo string of the parameter
+//! @param   [in]  deadband   deadband in engineering units (<= 0: disabled)
+//!
+//! @return  asynError if parameter does not exist or is no float parameter
+//------------------------------------------------------------------------------
+asynStatus drvAsynIsegVds::setDeadband( const char *paramName, double deadband ) {
+  int function = 0;
+  if( asynSuccess != findParam( paramName, &function ) ||
+      function >= NUM_ISEGVDS_REGISTERS ||
+      asynParamFloat64 != isegVdsRegisters[function].type )
+    return asynError;
+
+  lock();
+  _deadbands[function] = ( deadband > 0. ) ? deadband : 0.;
+  unlock();
+  return asynSuccess;
+}
+
+//------------------------------------------------------------------------------
+//! @brief   Publish the array parameters of one module
+//!
+//! @param   [in]  addr      asyn address of the module
+//! @param   [in]  chanData  snapshot of the register blocks of all channels
+//------------------------------------------------------------------------------
+void drvAsynIsegVds::doArrayCallbacks( int addr, const epicsUInt32* chanData, const epicsFloat64* chanValues ) {
+  const epicsUInt32 chanWords = _blockWords[ISEGVDS_CHANNEL];
+  epicsFloat64 data[ISEGVDS_NCHANNELS];
+  epicsInt32   status[ISEGVDS_NCHANNELS];
+
+  static const int floatArrays[] = { P_VSetAll, P_VMomAll, P_IMomAll };
+  for( size_t i = 0; i < sizeof( floatArrays ) / sizeof( floatArrays[0] ); ++i ) {
+    int element = arrayElement( floatArrays[i] );
+    epicsUInt32 idx = isegVdsRegisters[element].offset / 4;
+    for( int ch = 0; ch < ISEGVDS_NCHANNELS; ++ch )
+      data[ch] = chanValues[ch * chanWords + idx];
+    doCallbacksFloat64Array( data, ISEGVDS_NCHANNELS, floatArrays[i], addr );
+  }
+
+  epicsUInt32 idx = isegVdsRegisters[P_ChanStatus].offset / 4;
+  for( int ch = 0; ch < ISEGVDS_NCHANNELS; ++ch )
+    status[ch] = chanData[ch * chanWords + idx];
+  doCallbacksInt32Array( status, ISEGVDS_NCHANNELS, P_ChanStatusAll, addr );
+}
+
+//------------------------------------------------------------------------------
+//! @brief   Poll all registers of one module
+//!
+//! The module block and the blocks of all channels are transferred back to
+//! back before the parameter library is touched, so the bus traffic of one
+//! module is not interleaved with the comparison against the shadow copies.
+//! The callbacks of all addresses of the module are done at the end and
+//! carry the time stamp of the channel transfers, see readChannelBlocks().
+//!
+//! @param   [in]  module    module number
+//! @param   [in]  modData   buffer for the module register block
+//! @param   [in]  chanData  buffer for the register blocks of all channels
+//!
+//! @return  status of the first failed VME transfer, the parameters are
+//!          not touched in this case
+//------------------------------------------------------------------------------
+VmeMaster::Status drvAsynIsegVds::pollModule( size_t module, epicsUInt32* modData, epicsUInt32* chanData ) {
+  const epicsUInt32 chanWords = _blockWords[ISEGVDS_CHANNEL];
+  const int modAddr = module * ISEGVDS_NCHANNELS;
+  epicsTimeStamp snapshot;
+
+  VmeMaster::Status status = readBlock( module, 0x0000, _blockWords[ISEGVDS_MODULE], modData );
+  if( VmeMaster::SUCCESS == status ) status = readChannelBlocks( module, chanData, snapshot );
+  if( status ) return status;
+
+  epicsFloat64 *modValues  = &_modValues[0];
+  epicsFloat64 *chanValues = &_chanValues[0];
+  convertBlocks( ISEGVDS_MODULE, modData, 1, modValues );
+  convertBlocks( ISEGVDS_CHANNEL, chanData, ISEGVDS_NCHANNELS, chanValues );
+
+  beginCycle( snapshot );
+  updateBlock( modAddr, ISEGVDS_MODULE, modData, modValues, _modImage[module] );
+  for( int ch = 0; ch < ISEGVDS_NCHANNELS; ++ch )
+    updateBlock( modAddr + ch, ISEGVDS_CHANNEL, chanData + ch * chanWords, chanValues + ch * chanWords,
+                 _chanImage[modAddr + ch] );
+
+  for( int ch = 0; ch < ISEGVDS_NCHANNELS; ++ch ) {
+    updateActivity( modAddr + ch, chanData + ch * chanWords );
+    recordHistory( modAddr + ch, chanData + ch * chanWords, chanValues + ch * chanWords );
+  }
+
+  for( int ch = 0; ch < ISEGVDS_NCHANNELS; ++ch )
+    markDirty( modAddr + ch );
+  doArrayCallbacks( modAddr, chanData, chanValues );
+  aggregateModule( module, chanData, chanValues );
+  endCycle();
+  return VmeMaster::SUCCESS;
+}
+
+//------------------------------------------------------------------------------
+//! @brief   Aggregate the channels of a module and publish the aggregate
+//!
+//! Called with the snapshot of all channels of a poll, in an open update
+//! cycle.
+//!
+//! @param   [in]  module      module number
+//! @param   [in]  chanData    register blocks of all channels
+//! @param   [in]  chanValues  register blocks converted by convertBlocks()
+//------------------------------------------------------------------------------
+void drvAsynIsegVds::aggregateModule( size_t module, const epicsUInt32* chanData, const epicsFloat64* chanValues ) {
+  const epicsUInt32 chanWords = _blockWords[ISEGVDS_CHANNEL];
+  const epicsUInt32 statusIdx = isegVdsRegisters[P_ChanStatus].offset / 4;
+  const epicsUInt32 vmomIdx   = isegVdsRegisters[P_ChanVmom].offset / 4;
+  const epicsUInt32 imomIdx   = isegVdsRegisters[P_ChanImom].offset / 4;
+
+  isegVdsAggregate& aggregate = _moduleAggregate[module];
+  clearAggregate( aggregate );
+  for( int ch = 0; ch < ISEGVDS_NCHANNELS; ++ch ) {
+    const epicsUInt32 status = chanData[ch * chanWords + statusIdx];
+    const epicsFloat64 vmom  = chanValues[ch * chanWords + vmomIdx];
+    const epicsFloat64 imom  = chanValues[ch * chanWords + imomIdx];
+    isegVdsAggregate channel;
+    channel.channels  = 1;
+    channel.statusOr  = status;
+    channel.statusAnd = status;
+    channel.vmomMin   = channel.vmomMax = magnitude( vmom );
+    channel.vmomSum   = vmom;
+    channel.imomMin   = channel.imomMax = magnitude( imom );
+    channel.imomSum   = imom;
+    channel.on        = ( status & ISEGVDS_CHANSTATUS_ON ) ? 1 : 0;
+    channel.ramping   = ( status & ISEGVDS_CHANSTATUS_RAMPING ) ? 1 : 0;
+    mergeAggregate( aggregate, channel );
+  }
+  publishAggregate( module * ISEGVDS_NCHANNELS, P_ModStatusOr, aggregate );
+}
+
+//------------------------------------------------------------------------------
+//! @brief   Store an aggregate in the parameter library
+//!
+//! @param   [in]  addr       asyn address
+//! @param   [in]  first      P_ModStatusOr or P_PortStatusOr
+//! @param   [in]  aggregate  aggregate to publish
+//------------------------------------------------------------------------------
+void drvAsynIsegVds::publishAggregate( int addr, int first, const isegVdsAggregate& aggregate ) {
+  const int offset = first - P_ModStatusOr;
+  const double channels = aggregate.channels ? aggregate.channels : 1.;
+  setBits( addr, P_ModStatusOr + offset,  aggregate.channels ? aggregate.statusOr : 0, 0xffffffff );
+  setBits( addr, P_ModStatusAnd + offset, aggregate.channels ? aggregate.statusAnd : 0, 0xffffffff );
+  setDoubleParam( addr, P_ModVmomMin + offset,  aggregate.vmomMin );
+  setDoubleParam( addr, P_ModVmomMax + offset,  aggregate.vmomMax );
+  setDoubleParam( addr, P_ModVmomMean + offset, aggregate.vmomSum / channels );
+  setDoubleParam( addr, P_ModVmomSum + offset,  aggregate.vmomSum );
+  setDoubleParam( addr, P_ModImomMin + offset,  aggregate.imomMin );
+  setDoubleParam( addr, P_ModImomMax + offset,  aggregate.imomMax );
+  setDoubleParam( addr, P_ModImomMean + offset, aggregate.imomSum / channels );
+  setDoubleParam( addr, P_ModImomSum + offset,  aggregate.imomSum );
+  setIntegerParam( addr, P_ModChansOn + offset,      aggregate.on );
+  setIntegerParam( addr, P_ModChansRamping + offset, aggregate.ramping );
+  markDirty( addr );
+}
+
+//------------------------------------------------------------------------------
+//! @brief   Aggregate the modules of the port and publish the aggregate
+//!
+//! Disconnected modules and modules not polled yet are left out.
+//------------------------------------------------------------------------------
+void drvAsynIsegVds::publishPortAggregate() {
+  isegVdsAggregate aggregate;
+  clearAggregate( aggregate );
+  for( size_t module = 0; module < _bases.size(); ++module )
+    if( _moduleUp[module] ) mergeAggregate( aggregate, _moduleAggregate[module] );
+
+  epicsTimeStamp now;
+  epicsTimeGetCurrent( &now );
+  beginCycle( now );
+  publishAggregate( 0, P_PortStatusOr, aggregate );
+  endCycle();
+}
+
+//------------------------------------------------------------------------------
+//! @brief   Remember if a channel needs to be polled at the fast rate
+//!
+//! @param   [in]  addr      asyn address of the channel
+//! @param   [in]  chanData  snapshot of the register block of the channel
+//------------------------------------------------------------------------------
+void drvAsynIsegVds::updateActivity( int addr, const epicsUInt32* chanData ) {
+  _chanActive[addr] = ( chanData[isegVdsRegisters[P_ChanStatus].offset / 4] & ISEGVDS_CHANSTATUS_RAMPING ) ||
+                      chanData[isegVdsRegisters[P_ChanEvtStatus].offset / 4];
+}
+
+//------------------------------------------------------------------------------
+//! @brief   Append the measured values of a channel to its history
+//!
+//! A new trip freezes the history of the channel, it is published with
+//! the next call of publishHistory(). Only the rising edge of the trip bit
+//! freezes, so a history rearmed while the channel is still tripped keeps
+//! recording. The trip bit is remembered per channel rather than taken
+//! from the shadow copy, which the event handler updates without calling
+//! this. Has to be called within an update cycle.
+//!
+//! @param   [in]  addr      asyn address of the channel
+//! @param   [in]  chanData  snapshot of the register block of the channel
+//------------------------------------------------------------------------------
+void drvAsynIsegVds::recordHistory( int addr, const epicsUInt32* chanData, const epicsFloat64* chanValues ) {
+  static const char *functionName = "recordHistory";
+  if( !_historySize ) return;
+  const bool tripped = chanData[isegVdsRegisters[P_ChanStatus].offset / 4] & ISEGVDS_CHANSTATUS_TRIP;
+  const bool newTrip = tripped && !_historyTripped[addr];
+  _historyTripped[addr] = tripped;
+  if( _vmomHistory[addr].frozen() ) return;
+
+  _vmomHistory[addr].push( chanValues[isegVdsRegisters[P_ChanVmom].offset / 4] );
+  _imomHistory[addr].push( chanValues[isegVdsRegisters[P_ChanImom].offset / 4] );
+  if( !newTrip ) return;
+
+  _vmomHistory[addr].freeze();
+  _imomHistory[addr].freeze();
+  _historyCaptured[addr] = false;
+  _nextHistory.secPastEpoch = 0;
+  setIntegerParam( addr, P_HistoryFrozen, 1 );
+  markDirty( addr );
+  asynPrint( pasynUserSelf, ASYN_TRACE_FLOW,
+             "%s:%s:%s: trip of channel %d, history frozen\n",
+             driverName, _deviceName, functionName, addr );
+}
+
+//------------------------------------------------------------------------------
+//! @brief   Publish the history of all channels if it is due
+//!
+//! A frozen history is published once. Has to be called with the port
+//! locked.
+//------------------------------------------------------------------------------
+void drvAsynIsegVds::publishHistory() {
+  if( !_historySize ) return;
+  epicsTimeStamp now;
+  epicsTimeGetCurrent( &now );
+  if( epicsTimeDiffInSeconds( &now, &_nextHistory ) < 0. ) return;
+  _nextHistory = now;
+  epicsTimeAddSeconds( &_nextHistory, _historyPeriod );
+
+  beginCycle( now );
+  for( int addr = 0; addr < _chanAddrs; ++addr ) {
+    if( _historyCaptured[addr] ) continue;
+    if( _vmomHistory[addr].frozen() ) _historyCaptured[addr] = true;
+    size_t n = _vmomHistory[addr].copy( &_historyData[0], _historyData.size() );
+    doCallbacksFloat64Array( &_historyData[0], n, P_VMomHistory, addr );
+    n = _imomHistory[addr].copy( &_historyData[0], _historyData.size() );
+    doCallbacksFloat64Array( &_historyData[0], n, P_IMomHistory, addr );
+  }
+  endCycle();
+}
+
+//------------------------------------------------------------------------------
+//! @brief   Keep a history of the measured values of all channels
+//!
+//! The poller appends the measured values of every channel at each poll,
+//! all channels are polled at the fast rate then. Requires the background
+//! poller.
+//!
+//! @param   [in]  samples  number of samples per channel (0: disabled)
+//! @param   [in]  period   interval of publishing the history in seconds
+//!
+//! @return  asynError if the poller is not running or the period is invalid
+//------------------------------------------------------------------------------
+asynStatus drvAsynIsegVds::setHistory( size_t samples, double period ) {
+  if( !_pollThread || ( samples && period <= 0. ) ) return asynError;
+
+  lock();
+  _historySize   = samples;
+  _historyPeriod = period;
+  _nextHistory.secPastEpoch = 0;
+  for( int addr = 0; addr < _chanAddrs; ++addr ) {
+    _vmomHistory[addr].resize( samples );
+    _imomHistory[addr].resize( samples );
+    setIntegerParam( addr, P_HistoryFrozen, 0 );
+    callParamCallbacks( addr, addr );
+  }
+  _historyCaptured.assign( _chanAddrs, false );
+  _historyTripped.assign( _chanAddrs, false );
+  _historyData.assign( samples, 0. );
+  unlock();
+  return asynSuccess;
+}
+
+//------------------------------------------------------------------------------
+//! @brief   Start or stop the ramp engine
+//!
+//! Starting moves all channels with a new RampTarget, stopping leaves the
+//! setpoints where they are. Has to be called with the port locked.
+//!
+//! @param   [in]  run  start (true) or stop (false) the ramp
+//------------------------------------------------------------------------------
+void drvAsynIsegVds::startRamp( bool run ) {
+  static const char *functionName = "startRamp";
+  int channels = 0;
+  for( int addr = 0; addr < _chanAddrs; ++addr ) {
+    if( !run ) {
+      _rampActive[addr] = false;
+      continue;
+    }
+    if( !_rampPending[addr] ) continue;
+    _rampPending[addr] = false;
+    getDoubleParam( addr, P_ChanVset, &_rampSet[addr] );
+    _rampUp[addr]     = magnitude( _rampTarget[addr] ) > magnitude( _rampSet[addr] );
+    _rampActive[addr] = true;
+    ++channels;
+  }
+  if( run && !channels && !_rampRunning ) run = false;
+  if( run && !_rampRunning ) epicsTimeGetCurrent( &_lastRamp );
+  _rampRunning = run;
+  setIntegerParam( 0, P_RampRun, run ? 1 : 0 );
+  callParamCallbacks( 0, 0 );
+  asynPrint( pasynUserSelf, ASYN_TRACE_FLOW,
+             "%s:%s:%s: ramp %s, %d channel(s) added\n",
+             driverName, _deviceName, functionName, run ? "running" : "stopped", channels );
+}
+
+//------------------------------------------------------------------------------
+//! @brief   Do one step of the ramp engine
+//!
+//! The setpoints of all channels of the ramp move towards their targets
+//! with at most _rampSpeed. With _rampMaxDiff set, no channel gets a
+//! setpoint more than _rampMaxDiff ahead of the measured voltage of the
+//! slowest channel ramping in the same direction, so the channels stay
+//! together. The measured values of the last poll are the feedback, the
+//! new setpoints of one module are written in one transaction. A channel
+//! leaves the ramp once its setpoint is at the target and it no longer
+//! ramps. A channel which is off, tripped, inhibited or in emergency off
+//! does not follow its setpoint, it leaves the ramp at once and does not
+//! hold back the others. Has to be called by the poller with the port
+//! locked.
+//------------------------------------------------------------------------------
+void drvAsynIsegVds::runRamp() {
+  static const char *functionName = "runRamp";
+  if( !_rampRunning ) return;
+
+  epicsTimeStamp now;
+  epicsTimeGetCurrent( &now );
+  double dt = epicsTimeDiffInSeconds( &now, &_lastRamp );
+  _lastRamp = now;
+  // no large step after the poller was held up
+  if( dt > 1. ) dt = 1.;
+
+  // channels which can not follow their setpoint
+  const epicsUInt32 failed = ISEGVDS_CHANSTATUS_TRIP | ISEGVDS_CHANSTATUS_INHIBIT | ISEGVDS_CHANSTATUS_EMCY;
+  for( int addr = 0; addr < _chanAddrs; ++addr ) {
+    if( !_rampActive[addr] ) continue;
+    epicsUInt32 status = 0;
+    getUIntDigitalParam( addr, P_ChanStatus, &status, 0xffffffff );
+    if( ( status & ISEGVDS_CHANSTATUS_ON ) && !( status & failed ) ) continue;
+    _rampActive[addr] = false;
+    asynPrint( pasynUserSelf, ASYN_TRACE_ERROR,
+               "%s:%s:%s: addr %d left the ramp, ChannelStatus 0x%04x (%s)\n",
+               driverName, _deviceName, functionName, addr, status,
+               ( status & ISEGVDS_CHANSTATUS_ON ) ? "trip, inhibit or emergency off" : "channel off" );
+  }
+
+  // slowest channels in each direction
+  double upFront = -1., downFront = -1.;
+  for( int addr = 0; addr < _chanAddrs; ++addr ) {
+    if( !_rampActive[addr] ) continue;
+    epicsFloat64 vmom = 0.;
+    getDoubleParam( addr, P_ChanVmom, &vmom );
+    const double m = magnitude( vmom );
+    if( _rampUp[addr] ) { if( upFront < 0. || m < upFront ) upFront = m; }
+    else if( m > downFront ) downFront = m;
+  }
+
+  const epicsUInt32 ramping = ISEGVDS_CHANSTATUS_RAMPING;
+  const isegVdsRegister& reg = isegVdsRegisters[P_ChanVset];
+  bool active = false;
+  beginCycle( now );
+  for( size_t module = 0; module < _bases.size(); ++module ) {
+    VmeMaster::TransactionList list;
+    std::vector<int> addrs;
+    std::vector<double> sets;
+    for( int ch = 0; ch < ISEGVDS_NCHANNELS; ++ch ) {
+      const int addr = module * ISEGVDS_NCHANNELS + ch;
+      if( !_rampActive[addr] ) continue;
+      const double target = _rampTarget[addr];
+      const double set    = _rampSet[addr];
+      if( set == target ) {
+        epicsUInt32 status = 0;
+        epicsFloat64 vmom = 0.;
+        getUIntDigitalParam( addr, P_ChanStatus, &status, ramping );
+        getDoubleParam( addr, P_ChanVmom, &vmom );
+        if( !status && ( _rampMaxDiff <= 0. || magnitude( vmom - target ) <= _rampMaxDiff ) )
+          _rampActive[addr] = false;
+        else
+          active = true;
+        continue;
+      }
+      active = true;
+
+      const double step = _rampSpeed * dt;
+      double next = magnitude( set );
+      if( _rampUp[addr] ) {
+        double limit = magnitude( target );
+        if( next + step < limit ) limit = next + step;
+        if( _rampMaxDiff > 0. && upFront + _rampMaxDiff < limit ) limit = upFront + _rampMaxDiff;
+        if( limit > next ) next = limit;
+      } else {
+        double limit = magnitude( target );
+        if( next - step > limit ) limit = next - step;
+        if( _rampMaxDiff > 0. && downFront - _rampMaxDiff > limit ) limit = downFront - _rampMaxDiff;
+        if( limit < next ) next = limit;
+      }
+      if( target < 0. || ( 0. == target && set < 0. ) ) next = -next;
+      if( next == set ) continue;
+
+      float_t vmeData;
+      vmeData.fval = (epicsFloat32)( next / reg.scale );
+      list.push_back( VmeMaster::writeCycle( VmeMaster::A16, VmeMaster::WIDTH32,
+                                             _bases[module] + registerAddress( reg, ch ), vmeData.ival ) );
+      addrs.push_back( addr );
+      sets.push_back( next );
+    }
+    if( list.empty() ) continue;
+
+    size_t executed;
+    VmeMaster::Status status = _vme->tryExecute( list, executed );
+    for( size_t i = 0; i < executed; ++i ) {
+      const int addr = addrs[i];
+      _rampSet[addr] = sets[i];
+      _cacheTime[addr][P_ChanVset].secPastEpoch = 0;
+      setDoubleParam( addr, P_ChanVset, sets[i] );
+      markDirty( addr );
+    }
+    if( status ) {
+      asynPrint( pasynUserSelf, ASYN_TRACE_ERROR,
+                 "%s:%s:%s: module %lu (BA 0x%04x): %s, ramp stopped\n",
+                 driverName, _deviceName, functionName,
+                 (unsigned long)module, _bases[module], VmeMaster::statusString( status ) );
+      active = false;
+      break;
+    }
+  }
+  endCycle();
+  if( !active ) startRamp( false );
+}
+
+//------------------------------------------------------------------------------
+//! @brief   Poll the active channels of one module
+//!
+//! Only the module status and module event status are read. The register
+//! blocks of all channels are read if the module reports ramping channels
+//! or an event, otherwise only those of channels which were ramping or had
+//! events at the last poll. In snapshot mode all channels are read with
+//! the link locked once as soon as one of them is active. With the history
+//! enabled all channels are read at every poll.
+//!
+//! @param   [in]  module    module number
+//! @param   [in]  modData   buffer for the module register block
+//! @param   [in]  chanData  buffer for the register blocks of all channels
+//!
+//! @return  status of the first failed VME transfer, channels polled
+//!          before it have been updated
+//------------------------------------------------------------------------------
+VmeMaster::Status drvAsynIsegVds::pollActive( size_t module, epicsUInt32* modData, epicsUInt32* chanData ) {
+  const epicsUInt32 chanWords = _blockWords[ISEGVDS_CHANNEL];
+  const int modAddr = module * ISEGVDS_NCHANNELS;
+
+  epicsTimeStamp snapshot;
+  epicsTimeGetCurrent( &snapshot );
+
+  // ModuleStatus and ModuleEventStatus are the first two words of the module block
+  VmeMaster::Status status = readBlock( module, 0x0000, 2, modData );
+  if( status ) return status;
+  const bool moduleActive = ( modData[0] & ISEGVDS_MODSTATUS_RAMPING ) || modData[1];
+
+  bool polled[ISEGVDS_NCHANNELS];
+  bool anyPolled = false;
+  bool snapshotTaken = false;
+  if( _snapshotMode ) {
+    // all channels in one transfer as soon as one of them is active
+    bool active = moduleActive || _historySize;
+    for( int ch = 0; ch < ISEGVDS_NCHANNELS; ++ch ) active = active || _chanActive[modAddr + ch];
+    if( active ) status = readChannelBlocks( module, chanData, snapshot );
+    snapshotTaken = active && !status;
+  }
+
+  beginCycle( snapshot );
+  storeWord( modAddr, P_ModStatus,    modData[0], _modImage[module] );
+  storeWord( modAddr, P_ModEvtStatus, modData[1], _modImage[module] );
+
+  for( int ch = 0; ch < ISEGVDS_NCHANNELS; ++ch ) {
+    int addr = modAddr + ch;
+    if( _snapshotMode ) {
+      polled[ch] = snapshotTaken;
+    } else {
+      // channels after a failed transfer are skipped
+      polled[ch] = !status && ( moduleActive || _chanActive[addr] || _historySize );
+      if( polled[ch] ) status = readBlock( module, chanAddr[ch], chanWords, chanData + ch * chanWords );
+      if( status ) polled[ch] = false;
+    }
+    if( !polled[ch] ) continue;
+    epicsFloat64 *values = &_chanValues[ch * chanWords];
+    convertBlocks( ISEGVDS_CHANNEL, chanData + ch * chanWords, 1, values );
+    updateBlock( addr, ISEGVDS_CHANNEL, chanData + ch * chanWords, values, _chanImage[addr] );
+    updateActivity( addr, chanData + ch * chanWords );
+    recordHistory( addr, chanData + ch * chanWords, values );
+    anyPolled = true;
+  }
+
+  markDirty( modAddr );
+  for( int ch = 1; ch < ISEGVDS_NCHANNELS; ++ch )
+    if( polled[ch] ) markDirty( modAddr + ch );
+
+  if( !anyPolled || status ) {
+    endCycle();
+    return status;
+  }
+  // complete the arrays with the shadow copies of the idle channels
+  for( int ch = 0; ch < ISEGVDS_NCHANNELS; ++ch ) {
+    const std::vector<epicsUInt32>& image = _chanImage[modAddr + ch];
+    if( polled[ch] || image.empty() ) continue;
+    std::copy( image.begin(), image.end(), chanData + ch * chanWords );
+    convertBlocks( ISEGVDS_CHANNEL, chanData + ch * chanWords, 1, &_chanValues[ch * chanWords] );
+  }
+  doArrayCallbacks( modAddr, chanData, &_chanValues[0] );
+  aggregateModule( module, chanData, &_chanValues[0] );
+  endCycle();
+  return VmeMaster::SUCCESS;
+}
+
+//------------------------------------------------------------------------------
+//! @brief   Background poller
+//!
+//! Reads the module register block and the register blocks of all channels
+//! of all modules every _slowPeriod seconds, updates the parameter library
+//! and does the callbacks for asyn clients with SCAN="I/O Intr".
+//! In between, every _pollPeriod seconds only the channels which are
+//! ramping or have events are polled.
+//! The modules are served one after another by this single thread, a VME
+//! error disconnects the module concerned. While the VME link is down the
+//! modules are not polled at all, after the link came back all modules get
+//! a full poll.
+//! Reconnects of the link and of disconnected modules are probed with an
+//! exponential backoff between retryMinDelay and retryMaxDelay.
+//! Polling and the publishing of history and statistics run in the lowest
+//! lanes, the port is left to asyn clients and the event handler after
+//! each module.
+//------------------------------------------------------------------------------
+void drvAsynIsegVds::pollerThread() {
+  std::vector<epicsUInt32> modData( _blockWords[ISEGVDS_MODULE] );
+  std::vector<epicsUInt32> chanData( _blockWords[ISEGVDS_CHANNEL] * ISEGVDS_NCHANNELS );
+
+  while( true ) {
+    epicsEventWaitWithTimeout( _pollEvent, _pollPeriod );
+
+    const size_t link = _bases.size();
+    if( _linkDown && retryDue( link ) && !_vme->reconnect() ) {
+      lock();
+      backoffRetry( link );
+      unlock();
+    }
+    if( _vme->isLinkUp() == _linkDown ) {
+      lock();
+      setLinkConnected( _vme->isLinkUp() );
+      unlock();
+    }
+
+    for( size_t module = 0; module < _bases.size() && !_linkDown; ++module ) {
+      // release the port between modules, so client requests and the
+      // event handler wait for one module at most
+      lockLane( ISEGVDS_LANE_POLL );
+      if( !_moduleUp[module] ) {
+        if( retryDue( module ) ) {
+          if( probeModule( module, &modData[0], &chanData[0] ) ) backoffRetry( module );
+          else setModuleConnected( module, true );
+        }
+        unlock();
+        continue;
+      }
+
+      epicsTimeStamp start;
+      epicsTimeGetCurrent( &start );
+      VmeMaster::Status status;
+      if( epicsTimeDiffInSeconds( &start, &_nextFullPoll[module] ) >= 0. ) {
+        epicsTimeStamp next = start;
+        epicsTimeAddSeconds( &next, _slowPeriod );
+        _nextFullPoll[module] = next;
+        status = pollModule( module, &modData[0], &chanData[0] );
+      } else {
+        status = pollActive( module, &modData[0], &chanData[0] );
+      }
+      if( VmeMaster::SUCCESS == status ) {
+        _latency[ISEGVDS_STAT_POLL].add( start );
+      } else {
+        _latency[ISEGVDS_STAT_POLL].addError();
+        if( VmeMaster::BUS_ERROR == status ) setModuleConnected( module, false );
+      }
+      unlock();
+    }
+
+    lockLane( ISEGVDS_LANE_POLL );
+    if( _coalesceWrites ) {
+      // writes to modules which were not polled in this cycle
+      epicsTimeStamp now;
+      epicsTimeGetCurrent( &now );
+      beginCycle( now );
+      endCycle();
+    }
+    if( !_linkDown ) runRamp();
+    yieldLane( ISEGVDS_LANE_BACKGROUND );
+    publishPortAggregate();
+    publishHistory();
+    yieldLane( ISEGVDS_LANE_BACKGROUND );
+    publishStatistics();
+    bool saveDue = false;
+    if( _imageFile && _imagePeriod > 0. ) {
+      epicsTimeStamp now;
+      epicsTimeGetCurrent( &now );
+      saveDue = epicsTimeDiffInSeconds( &now, &_nextImage ) >= 0.;
+      if( saveDue ) {
+        _nextImage = now;
+        epicsTimeAddSeconds( &_nextImage, _imagePeriod );
+      }
+    }
+    unlock();
+    if( saveDue ) saveImage();
+  }
+}
+
+//------------------------------------------------------------------------------
+//! @brief   Lock the port for an asyn client
+//!
+//! Overrides asynPortDriver::lock(). Register writes of asyn clients lock
+//! the port in the write lane, all other calls of other threads in the
+//! client lane, see laneWrite(). The poller and the event handler lock
+//! the port with lockLane(), their other calls and nested calls of the
+//! thread holding the port take it right away.
+//!
+//! Invariants making the checks outside the mutex safe:
+//! - _lockOwner and _lockDepth are only written by the thread holding the
+//!   port mutex, after taking it in lock() or lockLane() and before
+//!   releasing it in unlock(). _lockDepth is only read by that thread.
+//! - Other threads read _lockOwner without the mutex, but only compare it
+//!   with their own id. A thread sees its own id there only while it holds
+//!   the port, any other value, stale or not, sends it through a lane.
+//! - Nested calls of the holder, e.g. from callbacks done with the port
+//!   locked, must not wait in a lane: a lane waiting for the port the
+//!   thread already holds would never be served. The asynPortDriver mutex
+//!   is recursive, so they take it again right away.
+//! - The poller and the event handler queue only at their explicit
+//!   lockLane() calls and leave the port at yieldLane() checkpoints, their
+//!   lock() calls in between are nested or outside any lane. Until
+//!   _pollThread and _eventThread are set, a lock() of these threads not
+//!   holding the port goes through the client lane, which only costs
+//!   priority, nested ones are found by _lockOwner.
+//! - laneWriter is thread private, set and cleared by the writing thread
+//!   around the call of the asynPortDriver write function, so only that
+//!   thread's own lock() sees it.
+//------------------------------------------------------------------------------
+asynStatus drvAsynIsegVds::lock() {
+  epicsThreadId self = epicsThreadGetIdSelf();
+  if( self == _lockOwner || self == _pollThread || self == _eventThread ) {
+    asynStatus status = asynPortDriver::lock();
+    _lockOwner = self;
+    ++_lockDepth;
+    return status;
+  }
+  const bool write = laneWriter && epicsThreadPrivateGet( laneWriter ) == this;
+  lockLane( write ? ISEGVDS_LANE_WRITE : ISEGVDS_LANE_CLIENT );
+  return asynSuccess;
+}
+
+//------------------------------------------------------------------------------
+//! @brief   Unlock the port
+//!
+//! Overrides asynPortDriver::unlock(). Clears the owner before the mutex
+//! is released, see lock().
+//------------------------------------------------------------------------------
+asynStatus drvAsynIsegVds::unlock() {
+  if( 0 == --_lockDepth ) _lockOwner = 0;
+  return asynPortDriver::unlock();
+}
+
+//------------------------------------------------------------------------------
+//! @brief   Check if a parameter is written to the registers of a module
+//------------------------------------------------------------------------------
+bool drvAsynIsegVds::isRegisterWrite( int function ) const {
+  return ( function >= 0 && function < NUM_ISEGVDS_REGISTERS ) || arrayElement( function ) >= 0;
+}
+
+//------------------------------------------------------------------------------
+//! @brief   Write of an asyn client through the interposed interfaces
+//!
+//! Marks the thread while it locks the port for a register write, so
+//! lock() puts setpoint and control writes in the write lane.
+//------------------------------------------------------------------------------
+asynStatus drvAsynIsegVds::laneWrite( asynUser *pasynUser, epicsFloat64 value ) {
+  const bool write = isRegisterWrite( pasynUser->reason );
+  if( write ) epicsThreadPrivateSet( laneWriter, this );
+  asynStatus status = ( (asynFloat64 *)_prevInterfaces[0]->pinterface )->write( _prevInterfaces[0]->drvPvt, pasynUser, value );
+  if( write ) epicsThreadPrivateSet( laneWriter, 0 );
+  return status;
+}
+
+asynStatus drvAsynIsegVds::laneWrite( asynUser *pasynUser, epicsUInt32 value, epicsUInt32 mask ) {
+  const bool write = isRegisterWrite( pasynUser->reason );
+  if( write ) epicsThreadPrivateSet( laneWriter, this );
+  asynStatus status = ( (asynUInt32Digital *)_prevInterfaces[1]->pinterface )->write( _prevInterfaces[1]->drvPvt, pasynUser,
+                                                                                      value, mask );
+  if( write ) epicsThreadPrivateSet( laneWriter, 0 );
+  return status;
+}
+
+asynStatus drvAsynIsegVds::laneWrite( asynUser *pasynUser, epicsFloat64 *value, size_t nElements ) {
+  const bool write = isRegisterWrite( pasynUser->reason );
+  if( write ) epicsThreadPrivateSet( laneWriter, this );
+  asynStatus status = ( (asynFloat64Array *)_prevInterfaces[2]->pinterface )->write( _prevInterfaces[2]->drvPvt, pasynUser,
+                                                                                     value, nElements );
+  if( write ) epicsThreadPrivateSet( laneWriter, 0 );
+  return status;
+}
+
+//------------------------------------------------------------------------------
+//! @brief   Interpose the write functions of the port
+//!
+//! asynPortDriver locks the port before the request reaches the driver,
+//! so the reason of a write is looked at in front of it. The other
+//! functions of the interfaces are the ones of asynPortDriver.
+//------------------------------------------------------------------------------
+void drvAsynIsegVds::interposeWrites() {
+  static const char *functionName = "interposeWrites";
+  static const char *types[3] = { asynFloat64Type, asynUInt32DigitalType, asynFloat64ArrayType };
+  void *interfaces[3] = { &_laneFloat64, &_laneUInt32Digital, &_laneFloat64Array };
+  if( !laneWriter ) laneWriter = epicsThreadPrivateCreate();
+
+  for( int i = 0; i < 3; ++i ) {
+    _laneInterfaces[i].interfaceType = types[i];
+    _laneInterfaces[i].pinterface    = interfaces[i];
+    _laneInterfaces[i].drvPvt        = this;
+    _prevInterfaces[i] = 0;
+    if( asynSuccess != pasynManager->interposeInterface( portName, -1, &_laneInterfaces[i], &_prevInterfaces[i] ) ||
+        !_prevInterfaces[i] ) {
+      fprintf( stderr, "\033[31;1m %s:%s: Could not interpose %s. \033[0m \n",
+               driverName, functionName, types[i] );
+      return;
+    }
+    // no request reaches the port before the constructor returned
+    _laneInterfaces[i].drvPvt = _prevInterfaces[i]->drvPvt;
+    void *prev = _prevInterfaces[i]->pinterface;
+    switch( i ) {
+      case 0:
+        _laneFloat64 = *(asynFloat64 *)prev;
+        _laneFloat64.write = writeFloat64C;
+        break;
+      case 1:
+        _laneUInt32Digital = *(asynUInt32Digital *)prev;
+        _laneUInt32Digital.write = writeUInt32DigitalC;
+        break;
+      default:
+        _laneFloat64Array = *(asynFloat64Array *)prev;
+        _laneFloat64Array.write = writeFloat64ArrayC;
+        break;
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+//! @brief   Check if a lane with higher priority waits for the port
+//------------------------------------------------------------------------------
+bool drvAsynIsegVds::preempted( int lane ) const {
+  for( int i = 0; i < lane; ++i )
+    if( _laneWaiting[i] ) return true;
+  return false;
+}
+
+//------------------------------------------------------------------------------
+//! @brief   Lock the port in a priority lane and count the time waited for it
+//!
+//! Waits until no lane with higher priority waits for the port, the wait
+//! of one lane is bounded by the hold time of the lanes above it. The
+//! last waiter of a lane to get the port wakes the lanes below, a waiter
+//! getting the port wakes the next waiter of its own lane.
+//!
+//! @param   [in]  lane  one of the ISEGVDS_LANE_* lanes
+//------------------------------------------------------------------------------
+void drvAsynIsegVds::lockLane( int lane ) {
+  epicsTimeStamp start;
+  epicsTimeGetCurrent( &start );
+  __sync_fetch_and_add( &_laneWaiting[lane], 1 );
+  while( preempted( lane ) ) epicsEventWait( _laneEvents[lane] );
+  asynPortDriver::lock();
+  _lockOwner = epicsThreadGetIdSelf();
+  ++_lockDepth;
+  if( 0 == __sync_sub_and_fetch( &_laneWaiting[lane], 1 ) ) {
+    for( int i = lane + 1; i < ISEGVDS_NUM_LANES; ++i ) epicsEventSignal( _laneEvents[i] );
+  } else {
+    epicsEventSignal( _laneEvents[lane] );
+  }
+  _latency[ISEGVDS_STAT_LOCK].add( start );
+}
+
+//------------------------------------------------------------------------------
+//! @brief   Leave the port to lanes with higher priority
+//!
+//! Called with the port locked at points where no update cycle is open.
+//!
+//! @param   [in]  lane  lane of the caller
+//------------------------------------------------------------------------------
+void drvAsynIsegVds::yieldLane( int lane ) {
+  if( !preempted( lane ) ) return;
+  unlock();
+  lockLane( lane );
+}
+
+//------------------------------------------------------------------------------
+//! @brief   Check if the next reconnect probe is due
+//! @param   [in]  index  module number, _bases.size() for the link
+//------------------------------------------------------------------------------
+bool drvAsynIsegVds::retryDue( size_t index ) const {
+  epicsTimeStamp now;
+  epicsTimeGetCurrent( &now );
+  return epicsTimeDiffInSeconds( &now, &_nextRetry[index] ) >= 0.;
+}
+
+//------------------------------------------------------------------------------
+//! @brief   Schedule the next reconnect probe and double the backoff
+//! @param   [in]  index  module number, _bases.size() for the link
+//------------------------------------------------------------------------------
+void drvAsynIsegVds::backoffRetry( size_t index ) {
+  epicsTimeGetCurrent( &_nextRetry[index] );
+  epicsTimeAddSeconds( &_nextRetry[index], _retryDelay[index] );
+  _retryDelay[index] = ( 2. * _retryDelay[index] < retryMaxDelay ) ? 2. * _retryDelay[index] : retryMaxDelay;
+}
+
+//------------------------------------------------------------------------------
+//! @brief   Publish the state of the VME link
+//!
+//! A link going down disconnects the port, so requests of asyn clients
+//! fail immediately instead of each running into the dead link. After
+//! the link is up again all modules get a full poll. Has to be called with
+//! the port locked.
+//!
+//! @param   [in]  connected  state of the link
+//------------------------------------------------------------------------------
+void drvAsynIsegVds::setLinkConnected( bool connected ) {
+  static const char *functionName = "setLinkConnected";
+  const size_t link = _bases.size();
+
+  _linkDown = !connected;
+  asynPrint( pasynUserSelf, ASYN_TRACE_ERROR,
+             "%s:%s:%s: VME link %s\n", driverName, _deviceName, functionName,
+             connected ? "up, polling resumed" : "down, polling suspended" );
+  if( connected ) {
+    // modules disconnected while the link went down are probed right away
+    epicsTimeStamp due = { 0, 0 };
+    _nextFullPoll.assign( _bases.size(), due );
+    _nextRetry.assign( _bases.size() + 1, due );
+    _retryDelay.assign( _bases.size() + 1, retryMinDelay );
+    pasynManager->exceptionConnect( _portUser );
+  } else {
+    _retryDelay[link] = retryMinDelay;
+    backoffRetry( link );
+    pasynManager->exceptionDisconnect( _portUser );
+  }
+}
+
+//------------------------------------------------------------------------------
+//! @brief   Publish the state of a module
+//!
+//! Disconnects or connects the asyn addresses of all channels of the
+//! module. Has to be called with the port locked.
+//!
+//! @param   [in]  module     module number
+//! @param   [in]  connected  module answers
+//------------------------------------------------------------------------------
+void drvAsynIsegVds::setModuleConnected( size_t module, bool connected ) {
+  static const char *functionName = "setModuleConnected";
+  if( _moduleUp[module] == connected ) return;
+
+  _moduleUp[module] = connected;
+  asynPrint( pasynUserSelf, ASYN_TRACE_ERROR,
+             "%s:%s:%s: module %lu (BA 0x%04x) %s\n", driverName, _deviceName, functionName,
+             (unsigned long)module, _bases[module], connected ? "reconnected" : "not responding, disconnected" );
+  if( !connected ) {
+    _retryDelay[module] = retryMinDelay;
+    backoffRetry( module );
+  }
+  for( int ch = 0; ch < ISEGVDS_NCHANNELS; ++ch ) {
+    asynUser *pasynUser = _devUsers[module * ISEGVDS_NCHANNELS + ch];
+    if( connected ) pasynManager->exceptionConnect( pasynUser );
+    else            pasynManager->exceptionDisconnect( pasynUser );
+  }
+}
+
+//------------------------------------------------------------------------------
+//! @brief   Check if a disconnected module answers again
+//!
+//! Reads the module status. If the module answers the cached register
+//! values and the shadow copies of the module are dropped and a full poll
+//! brings the parameters up to date, calling back all bits of the status
+//! words. Has to be called with the port locked.
+//!
+//! @param   [in]  module    module number
+//! @param   [in]  modData   buffer for the module register block
+//! @param   [in]  chanData  buffer for the register blocks of all channels
+//!
+//! @return  status of the first failed VME transfer
+//------------------------------------------------------------------------------
+VmeMaster::Status drvAsynIsegVds::probeModule( size_t module, epicsUInt32* modData, epicsUInt32* chanData ) {
+  epicsUInt32 value;
+  VmeMaster::Status status = _vme->tryRead( VmeMaster::A16, VmeMaster::WIDTH32,
+                                            _bases[module] + isegVdsRegisters[P_ModStatus].offset, value );
+  if( status ) return status;
+
+  forgetModule( module );
+
+  epicsTimeStamp next;
+  epicsTimeGetCurrent( &next );
+  epicsTimeAddSeconds( &next, _slowPeriod );
+  _nextFullPoll[module] = next;
+  return pollModule( module, modData, chanData );
+}
+
+//------------------------------------------------------------------------------
+//! @brief   Drop the cached register values and the shadow copies of a module
+//!
+//! The next poll of the module updates and confirms all parameters of the
+//! module, not only the registers which changed. Has to be called with the
+//! port locked.
+//!
+//! @param   [in]  module    module number
+//------------------------------------------------------------------------------
+void drvAsynIsegVds::forgetModule( size_t module ) {
+  epicsTimeStamp unconfirmed = { 0, 0 };
+  _modImage[module].clear();
+  for( int ch = 0; ch < ISEGVDS_NCHANNELS; ++ch ) {
+    _cacheTime[module * ISEGVDS_NCHANNELS + ch].assign( NUM_ISEGVDS_REGISTERS, unconfirmed );
+    _chanImage[module * ISEGVDS_NCHANNELS + ch].clear();
+  }
+}
+
+//------------------------------------------------------------------------------
+//! @brief   Called by asynManager to connect the port or an asyn address
+//!
+//! Refuses the connect of a port whose constructor failed, and while the
+//! VME link is down or the module of the
+//! address does not answer, the poller reconnects them once they are back.
+//! The addresses of the statistics do not belong to a module.
+//------------------------------------------------------------------------------
+asynStatus drvAsynIsegVds::connect( asynUser *pasynUser ) {
+  static const char *functionName = "connect";
+  int addr = -1;
+  pasynManager->getAddr( pasynUser, &addr );
+
+  const char *reason = 0;
+  if( !_configured ) reason = "port not configured";
+  else if( _linkDown || !_vme->isLinkUp() ) reason = "VME link down";
+  else if( addr >= 0 && addr < _chanAddrs && !_moduleUp[addr / ISEGVDS_NCHANNELS] ) reason = "module not responding";
+  if( reason ) {
+    epicsSnprintf( pasynUser->errorMessage, pasynUser->errorMessageSize,
+                   "%s:%s:%s: addr=%d %s", driverName, _deviceName, functionName, addr, reason );
+    return asynError;
+  }
+  return asynPortDriver::connect( pasynUser );
+}
+
+//------------------------------------------------------------------------------
+//! @brief   Get the asyn address of a request
+//!
+//! Overrides asynPortDriver::getAddress(). The addresses behind the
+//! channels only serve the statistics parameters.
+//------------------------------------------------------------------------------
+asynStatus drvAsynIsegVds::getAddress( asynUser *pasynUser, int *address ) {
+  static const char *functionName = "getAddress";
+  asynStatus status = asynPortDriver::getAddress( pasynUser, address );
+  if( status ) return status;
+  const int function = pasynUser->reason;
+  if( *address >= _chanAddrs && ( function < P_StatCount || function > P_LinkContentions ) ) {
+    epicsSnprintf( pasynUser->errorMessage, pasynUser->errorMessageSize,
+                   "%s:%s:%s: addr=%d only serves statistics", driverName, _deviceName, functionName, *address );
+    return asynError;
+  }
+  return asynSuccess;
+}
+
+//------------------------------------------------------------------------------
+//! @brief   Copy latency and link statistics to the parameter library
+//!
+//! Min., average, p99 and max. are given in microseconds. The parameters
+//! of a class are at the asyn address _chanAddrs + class, the link
+//! statistics at _chanAddrs. Has to be called with the port locked.
+//------------------------------------------------------------------------------
+void drvAsynIsegVds::publishStatistics() {
+  epicsTimeStamp now;
+  epicsTimeGetCurrent( &now );
+  beginCycle( now );
+  for( int cls = 0; cls < ISEGVDS_NUM_STATS; ++cls ) {
+    const LatencyHistogram& h = _latency[cls];
+    const int addr = _chanAddrs + cls;
+    setIntegerParam( addr, P_StatCount,  h.count() );
+    setIntegerParam( addr, P_StatErrors, h.errors() );
+    setDoubleParam(  addr, P_StatMin,    h.min() );
+    setDoubleParam(  addr, P_StatAvg,    h.average() );
+    setDoubleParam(  addr, P_StatP99,    h.percentile( 0.99 ) );
+    setDoubleParam(  addr, P_StatMax,    h.max() );
+    markDirty( addr );
+  }
+  if( _vme ) {
+    VmeMaster::Statistics link = _vme->getStatistics();
+    setIntegerParam( _chanAddrs, P_LinkCycles,      link.cycles );
+    setIntegerParam( _chanAddrs, P_LinkErrors,      link.errors );
+    setIntegerParam( _chanAddrs, P_LinkContentions, link.contentions );
+  }
+  endCycle();
+}
+
+//------------------------------------------------------------------------------
+//! @brief   Report of the driver, called by asynReport and dbior
+//!
+//! @param   [in]  fp       file to print to
+//! @param   [in]  details  level of detail (> 0: also latency statistics and
+//!                         VME link, > 1: also parameter library)
+//------------------------------------------------------------------------------
+void drvAsynIsegVds::report( FILE *fp, int details ) {
+  static const char *statNames[ISEGVDS_NUM_STATS] = { "read", "write", "array", "poll", "event", "lock" };
+  if( !_configured ) {
+    fprintf( fp, "ISEG VDS port %s: not configured\n", _deviceName );
+    return;
+  }
+
+  fprintf( fp, "ISEG VDS port %s: %lu module(s), poll %g s / %g s, cache %g s%s\n",
+           _deviceName, (unsigned long)_bases.size(), _pollPeriod, _slowPeriod, _cacheMaxAge,
+           _coalesceWrites ? ", write callbacks coalesced" : "" );
+  if( _snapshotMode ) fprintf( fp, "  snapshots of all channels, time event %d\n", _timeEvent );
+  if( _historySize ) fprintf( fp, "  history of %lu samples, published every %g s\n",
+                              (unsigned long)_historySize, _historyPeriod );
+  if( _rampRunning ) fprintf( fp, "  ramp engine running, %g V/s, max. difference %g V\n",
+                              _rampSpeed, _rampMaxDiff );
+  if( _imageFile ) fprintf( fp, "  register image %s, saved every %g s\n", _imageFile, _imagePeriod );
+  if( _writeTimer ) fprintf( fp, "  write coalescing, %lu writes replaced\n", _writesCoalesced );
+  if( _linkDown ) fprintf( fp, "  VME link down\n" );
+  fprintf( fp, "  statistics at asyn addresses %d-%d\n", _chanAddrs, _chanAddrs + ISEGVDS_NUM_STATS - 1 );
+  for( size_t module = 0; module < _bases.size(); ++module )
+    fprintf( fp, "  module %lu: BA 0x%04x, asyn addresses %lu-%lu%s\n", (unsigned long)module, _bases[module],
+             (unsigned long)( module * ISEGVDS_NCHANNELS ), (unsigned long)( ( module + 1 ) * ISEGVDS_NCHANNELS - 1 ),
+             _moduleUp[module] ? "" : ", not responding" );
+  if( details < 1 ) return;
+
+  lock();
+  for( int cls = 0; cls < ISEGVDS_NUM_STATS; ++cls ) _latency[cls].report( fp, statNames[cls] );
+  unlock();
+  if( _vme ) _vme->report( fp, details - 1 );
+  if( details > 1 ) asynPortDriver::report( fp, details );
+}
+
+//------------------------------------------------------------------------------
+//! @brief   Called when asyn clients call pasynInt32->read().
+//!
+//! The statistics parameters are refreshed before the value is returned
+//! from the parameter library, the other asynInt32 parameters (ramp,
+//! history and aggregates) are kept up to date by the driver.
+//------------------------------------------------------------------------------
+asynStatus drvAsynIsegVds::readInt32( asynUser *pasynUser, epicsInt32 *value ) {
+  const int function = pasynUser->reason;
+  if( function >= P_StatCount && function <= P_LinkContentions ) publishStatistics();
+  return asynPortDriver::readInt32( pasynUser, value );
+}
+
+//------------------------------------------------------------------------------
+//! @brief   Called when asyn clients call pasynInt32->write().
+//!
+//! Writing HistoryFrozen freezes (1) or rearms (0) the history of a channel,
+//! writing RampRun starts (1) or stops (0) the ramp engine.
+//!
+//! @param   [in]  pasynUser  pasynUser structure that encodes the reason and address
+//! @param   [in]  value      Value to write
+//!
+//! @return  asynError if the parameter can not be written
+//------------------------------------------------------------------------------
+asynStatus drvAsynIsegVds::writeInt32( asynUser *pasynUser, epicsInt32 value ) {
+  int addr = 0;
+  asynStatus status = getAddress( pasynUser, &addr ); if( status != asynSuccess ) return status;
+  if( P_RampRun == pasynUser->reason ) {
+    if( !_pollThread ) return asynError;
+    startRamp( 0 != value );
+    return asynSuccess;
+  }
+  if( P_HistoryFrozen != pasynUser->reason || !_historySize ) return asynError;
+
+  if( value ) {
+    _vmomHistory[addr].freeze();
+    _imomHistory[addr].freeze();
+  } else {
+    _vmomHistory[addr].rearm();
+    _imomHistory[addr].rearm();
+  }
+  _historyCaptured[addr] = false;
+  setIntegerParam( addr, P_HistoryFrozen, value ? 1 : 0 );
+  return (asynStatus) callParamCallbacks( addr, addr );
+}
+
+//------------------------------------------------------------------------------
+//! @brief   Set the rates of the poller
+//!
+//! @param   [in]  fastPeriod  interval in seconds for polling ramping channels
+//!                            and channels with events
+//! @param   [in]  slowPeriod  interval in seconds for polling all registers
+//!
+//! @return  asynError if there is no poller or the periods are invalid
+//------------------------------------------------------------------------------
+asynStatus drvAsynIsegVds::setPollRates( double fastPeriod, double slowPeriod ) {
+  if( !_pollThread || fastPeriod <= 0. || slowPeriod < fastPeriod ) return asynError;
+
+  lock();
+  _pollPeriod = fastPeriod;
+  _slowPeriod = slowPeriod;
+  epicsTimeStamp due = { 0, 0 };
+  _nextFullPoll.assign( _bases.size(), due );
+  unlock();
+  epicsEventSignal( _pollEvent );
+  return asynSuccess;
+}
+
+//------------------------------------------------------------------------------
+//! @brief   Store a register read outside of the poller
+//!
+//! Updates the shadow copy as well, so the poller does not publish the
+//! same change a second time.
+//!
+//! @param   [in]     addr      asyn address
+//! @param   [in]     function  index of the parameter
+//! @param   [in]     vmeData   raw register content
+//! @param   [in,out] image     shadow copy of the register block of addr
+//------------------------------------------------------------------------------
+void drvAsynIsegVds::storeWord( int addr, int function, epicsUInt32 vmeData, std::vector<epicsUInt32>& image ) {
+  const bool cold = image.empty();
+  if( !cold ) image[isegVdsRegisters[function].offset / 4] = vmeData;
+  setParamStatus( addr, function, asynSuccess );
+  updateParam( addr, function, vmeData, toDouble( function, vmeData ), cold );
+}
+
+//------------------------------------------------------------------------------
+//! @brief   Open an update cycle
+//!
+//! Parameter updates within the cycle are only marked with markDirty(),
+//! endCycle() of the outermost cycle does one callParamCallbacks() per
+//! marked address. All callbacks carry the time the registers were read.
+//! Has to be called with the port locked.
+//!
+//! @param   [in]  snapshot  time of the VME reads the updates stem from
+//------------------------------------------------------------------------------
+void drvAsynIsegVds::beginCycle( const epicsTimeStamp& snapshot ) {
+  if( 0 == _cycleDepth++ ) setTimeStamp( &snapshot );
+}
+
+//------------------------------------------------------------------------------
+//! @brief   Remember that parameters of an asyn address were updated
+//! @param   [in]  addr  asyn address
+//------------------------------------------------------------------------------
+void drvAsynIsegVds::markDirty( int addr ) {
+  _dirty[addr] = true;
+}
+
+//------------------------------------------------------------------------------
+//! @brief   Close an update cycle, the outermost one does the callbacks
+//------------------------------------------------------------------------------
+void drvAsynIsegVds::endCycle() {
+  if( --_cycleDepth > 0 ) return;
+  for( int addr = 0; addr < maxAddr; ++addr ) {
+    if( !_dirty[addr] ) continue;
+    _dirty[addr] = false;
+    callParamCallbacks( addr, addr );
+  }
+}
+
+//------------------------------------------------------------------------------
+//! @brief   Do the callbacks for a single register write
+//!
+//! With coalescing enabled the address is only marked, the callbacks are
+//! done at the end of the next poll cycle.
+//!
+//! @param   [in]  addr  asyn address
+//! @param   [in]  when  time of the write
+//------------------------------------------------------------------------------
+void drvAsynIsegVds::publishWrite( int addr, const epicsTimeStamp& when ) {
+  if( _coalesceWrites ) {
+    markDirty( addr );
+    return;
+  }
+  beginCycle( when );
+  markDirty( addr );
+  endCycle();
+}
+
+//------------------------------------------------------------------------------
+//! @brief   Defer the callbacks of single writes to the poller
+//!
+//! A burst of writes to one channel then results in one callback per
+//! address and poll cycle. Requires the background poller.
+//!
+//! @param   [in]  enable  coalesce the callbacks of single writes
+//!
+//! @return  asynError if the poller is not running
+//------------------------------------------------------------------------------
+asynStatus drvAsynIsegVds::setCoalescing( bool enable ) {
+  if( !_pollThread ) return asynError;
+
+  lock();
+  _coalesceWrites = enable;
+  if( !enable ) {
+    // flush what was deferred so far
+    epicsTimeStamp now;
+    epicsTimeGetCurrent( &now );
+    beginCycle( now );
+    endCycle();
+  }
+  unlock();
+  return asynSuccess;
+}
+
+//------------------------------------------------------------------------------
+//! @brief   Read all channels of a module with the link locked once
+//!
+//! The poller then reads the channel blocks of a module in one transaction
+//! list and stamps all parameters with one time taken right after it.
+//! Reads of status and measured values are served from the last snapshot.
+//! Requires the background poller and a VME master mapping the A16
+//! windows of the modules, with single cycles the list would be neither
+//! faster nor consistent in time.
+//!
+//! @param   [in]  enable     use snapshots
+//! @param   [in]  timeEvent  event number for epicsTimeGetEvent() (0: system time)
+//!
+//! @return  asynError if the poller is not running or the windows are not mapped
+//------------------------------------------------------------------------------
+asynStatus drvAsynIsegVds::setSnapshotMode( bool enable, int timeEvent ) {
+  if( !_pollThread || ( enable && !_windowsMapped ) ) return asynError;
+
+  lock();
+  _snapshotMode = enable;
+  _timeEvent    = timeEvent;
+  epicsTimeStamp none = { 0, 0 };
+  _snapshotTime.assign( _bases.size(), none );
+  _nextFullPoll.assign( _bases.size(), none );
+  unlock();
+  epicsEventSignal( _pollEvent );
+  return asynSuccess;
+}
+
+//------------------------------------------------------------------------------
+//! @brief   Check the event registers of one module
+//!
+//! Reads the module event status and the event channel status in one
+//! transaction. Only for channels flagged in the event channel status the
+//! channel status and channel event status are read, all results are
+//! published at the end of the call. If acknowledge is set the event bits
+//! read are reset then (write 1 to clear), channel event status first, so
+//! a module raising its interrupt until the events are acknowledged (RORA)
+//! releases it. Otherwise the latched event registers are left to the
+//! operators.
+//!
+//! @param   [in]  module       module number
+//! @param   [in]  acknowledge  reset the event bits read
+//!
+//! @return  status of the first failed VME transfer
+//------------------------------------------------------------------------------
+VmeMaster::Status drvAsynIsegVds::handleEvents( size_t module, bool acknowledge ) {
+  const int modAddr = module * ISEGVDS_NCHANNELS;
+  const epicsUInt32 base = _bases[module];
+  epicsTimeStamp snapshot;
+  epicsTimeGetCurrent( &snapshot );
+
+  VmeMaster::TransactionList list;
+  list.push_back( VmeMaster::readCycle( VmeMaster::A16, VmeMaster::WIDTH32,
+                                        base + isegVdsRegisters[P_ModEvtStatus].offset ) );
+  list.push_back( VmeMaster::readCycle( VmeMaster::A16, VmeMaster::WIDTH32,
+                                        base + isegVdsRegisters[P_ModEvtChanStatus].offset ) );
+  size_t executed;
+  VmeMaster::Status status = _vme->tryExecute( list, executed );
+  if( status ) return status;
+  beginCycle( snapshot );
+  storeWord( modAddr, P_ModEvtStatus,     list[0].value, _modImage[module] );
+  storeWord( modAddr, P_ModEvtChanStatus, list[1].value, _modImage[module] );
+  markDirty( modAddr );
+
+  const epicsUInt32 modEvents  = list[0].value;
+  const epicsUInt32 chanEvents = list[1].value;
+  const epicsUInt32 flagged = chanEvents & ( ( 1 << ISEGVDS_NCHANNELS ) - 1 );
+  VmeMaster::TransactionList reset;
+  if( flagged ) {
+    list.clear();
+    for( int ch = 0; ch < ISEGVDS_NCHANNELS; ++ch ) {
+      if( !( flagged & ( 1 << ch ) ) ) continue;
+      list.push_back( VmeMaster::readCycle( VmeMaster::A16, VmeMaster::WIDTH32,
+                                            base + registerAddress( isegVdsRegisters[P_ChanStatus], ch ) ) );
+      list.push_back( VmeMaster::readCycle( VmeMaster::A16, VmeMaster::WIDTH32,
+                                            base + registerAddress( isegVdsRegisters[P_ChanEvtStatus], ch ) ) );
+    }
+    status = _vme->tryExecute( list, executed );
+    if( status ) {
+      // the module event registers are published nevertheless
+      endCycle();
+      return status;
+    }
+
+    size_t i = 0;
+    for( int ch = 0; ch < ISEGVDS_NCHANNELS; ++ch ) {
+      if( !( flagged & ( 1 << ch ) ) ) continue;
+      storeWord( modAddr + ch, P_ChanStatus,    list[i++].value, _chanImage[modAddr + ch] );
+      storeWord( modAddr + ch, P_ChanEvtStatus, list[i].value,   _chanImage[modAddr + ch] );
+      if( acknowledge )
+        reset.push_back( VmeMaster::writeCycle( VmeMaster::A16, VmeMaster::WIDTH32, list[i].address, list[i].value ) );
+      ++i;
+      markDirty( modAddr + ch );
+    }
+  }
+  endCycle();
+  if( !acknowledge ) return VmeMaster::SUCCESS;
 
-typedef union{
-  epicsFloat32 fval;
-  epicsUInt32  ival;
-} float_t;
+  if( modEvents )
+    reset.push_back( VmeMaster::writeCycle( VmeMaster::A16, VmeMaster::WIDTH32,
+                                            base + isegVdsRegisters[P_ModEvtStatus].offset, modEvents ) );
+  if( chanEvents )
+    reset.push_back( VmeMaster::writeCycle( VmeMaster::A16, VmeMaster::WIDTH32,
+                                            base + isegVdsRegisters[P_ModEvtChanStatus].offset, chanEvents ) );
+  if( reset.empty() ) return VmeMaster::SUCCESS;
+  return _vme->tryExecute( reset, executed );
+}
 
-//_____ G L O B A L S __________________________________________________________
+//------------------------------------------------------------------------------
+//! @brief   Event handler
+//!
+//! Waits for the VME interrupt of the modules if an interrupt level is
+//! configured and the VME master supports interrupts, otherwise polls the
+//! event status of all modules every _eventPeriod seconds. The events are
+//! acknowledged only in interrupt mode, where a RORA module needs it.
+//------------------------------------------------------------------------------
+void drvAsynIsegVds::eventThread() {
+  static const char *functionName = "eventThread";
+  const bool useIrq = ( _irqLevel > 0 && _vme->irqSupported() );
 
-//_____ L O C A L S ____________________________________________________________
-static const char *driverName = "drvAsynIsegVdsDriver";
-static const epicsUInt32 chanAddr[8] = { 0x0100, 0x0140, 0x0180, 0x01c0,
-                                         0x0200, 0x0240, 0x0280, 0x02c0 };
+  while( true ) {
+    if( useIrq ) {
+      uint32_t vector = 0;
+      bool received = false;
+      VmeMaster::Status status = _vme->tryWaitForIrq( _irqLevel, _eventPeriod, &vector, received );
+      if( status ) {
+        asynPrint( pasynUserSelf, ASYN_TRACE_ERROR,
+                   "%s:%s:%s: waiting for VME IRQ %d failed: %s\n",
+                   driverName, _deviceName, functionName, _irqLevel, VmeMaster::statusString( status ) );
+        epicsThreadSleep( _eventPeriod );
+        continue;
+      }
+      if( !received ) continue;
+    } else {
+      epicsThreadSleep( _eventPeriod );
+    }
 
-//_____ F U N C T I O N S ______________________________________________________
+    // the poller reports the link state
+    if( !_vme->isLinkUp() ) continue;
+
+    lockLane( ISEGVDS_LANE_EVENT );
+    for( size_t module = 0; module < _bases.size(); ++module ) {
+      yieldLane( ISEGVDS_LANE_EVENT );
+      if( !_moduleUp[module] ) continue;
+      epicsTimeStamp start;
+      epicsTimeGetCurrent( &start );
+      VmeMaster::Status status = handleEvents( module, useIrq );
+      if( VmeMaster::SUCCESS == status ) {
+        _latency[ISEGVDS_STAT_EVENT].add( start );
+      } else {
+        _latency[ISEGVDS_STAT_EVENT].addError();
+        if( VmeMaster::LINK_DOWN == status ) break;
+        asynPrint( pasynUserSelf, ASYN_TRACE_ERROR,
+                   "%s:%s:%s: module %lu (BA 0x%04x): %s\n",
+                   driverName, _deviceName, functionName,
+                   (unsigned long)module, _bases[module], VmeMaster::statusString( status ) );
+      }
+    }
+    unlock();
+  }
+}
+
+//------------------------------------------------------------------------------
+//! @brief   Start the event handler
+//!
+//! @param   [in]  period    interval of the event status poll in seconds
+//! @param   [in]  irqLevel  VME interrupt level the modules are configured
+//!                          for (0: poll the event status)
+//!
+//! @return  asynError if the event handler is already running or could
+//!          not be started
+//------------------------------------------------------------------------------
+asynStatus drvAsynIsegVds::startEventHandler( double period, int irqLevel ) {
+  static const char *functionName = "startEventHandler";
+  if( _eventThread || !_vme || period <= 0. ) return asynError;
+
+  _eventPeriod = period;
+  _irqLevel    = irqLevel;
+  if( _irqLevel > 0 && !_vme->irqSupported() )
+    fprintf( stderr, "%s:%s: VME master has no interrupt support, polling event status of %s\n",
+             driverName, functionName, _deviceName );
+
+  char threadName[100];
+  epicsSnprintf( threadName, sizeof( threadName ), "%sEvents", _deviceName );
+  _eventThread = epicsThreadCreate( threadName,
+                                    epicsThreadPriorityHigh,
+                                    epicsThreadGetStackSize( epicsThreadStackMedium ),
+                                    (EPICSTHREADFUNC)eventThreadC,
+                                    this );
+  if( !_eventThread ) {
+    fprintf( stderr, "\033[31;1m %s:%s: Could not create event thread. \033[0m \n",
+             driverName, functionName );
+    return asynError;
+  }
+  return asynSuccess;
+}
 
 //------------------------------------------------------------------------------
 //! @brief   Called when asyn clients call pasynUInt32Digital->read().
@@ -87,27 +2431,37 @@ asynStatus drvAsynIsegVds::readUInt32Digital( asynUser *pasynUser, epicsUInt32 *
   epicsUInt32 vmeAddr = 0;
     
   status = getAddress( pasynUser, &addr ); if( status ) return status;
+  if( function >= P_ModStatusOr && function <= P_PortChansRamping )
+    return asynPortDriver::readUInt32Digital( pasynUser, value, mask );
+  if( function < 0 || function >= NUM_ISEGVDS_REGISTERS ) return asynError;
 
-  cmdIter it = _modcmds.find( function );
-  if( _modcmds.end() == it ) {
-    it = _chancmds.find( function );
-    if( _chancmds.end() == it ) return asynError;
-    vmeAddr += chanAddr[addr];
+  if( isCacheValid( addr, function ) ) {
+    status = (asynStatus) getUIntDigitalParam( addr, function, value, mask );
+    pasynUser->timestamp = timeStamp;
+    return status;
   }
-  vmeAddr += it->second;
+  if( fromSnapshot( addr, function, pasynUser->timestamp ) )
+    return (asynStatus) getUIntDigitalParam( addr, function, value, mask );
+
+  vmeAddr = registerAddress( isegVdsRegisters[function], addr );
 
-  try {
-    vmeData = _vme->readRegisterA16D32( _base, vmeAddr );
-  } catch( VmeException &e ){
+  epicsTimeStamp start;
+  epicsTimeGetCurrent( &start );
+  VmeMaster::Status vmeStatus = _vme->tryRead( VmeMaster::A16, VmeMaster::WIDTH32,
+                                                _bases[addr / ISEGVDS_NCHANNELS] + vmeAddr, vmeData );
+  if( vmeStatus ) {
+    _latency[ISEGVDS_STAT_READ].addError();
     epicsSnprintf( pasynUser->errorMessage, pasynUser->errorMessageSize, 
                    "%s:%s: function=%d %s",
-                   driverName, functionName, function, e.what() );
+                   driverName, functionName, function, VmeMaster::statusString( vmeStatus ) );
     return asynError;
   }
+  _latency[ISEGVDS_STAT_READ].add( start );
 
-  status = (asynStatus) setUIntDigitalParam( addr, function, vmeData, mask );
+  confirmCache( addr, function );
+  status = setBits( addr, function, vmeData, mask );
   status = (asynStatus) getUIntDigitalParam( addr, function, value, mask );
-  pasynUser->timestamp = timeStamp;
+  pasynUser->timestamp = start;
   if( status ) 
     epicsSnprintf( pasynUser->errorMessage, pasynUser->errorMessageSize, 
                    "%s:%s: status=%d, function=%d, value=%d",
@@ -137,34 +2491,40 @@ asynStatus drvAsynIsegVds::writeUInt32Digital( asynUser *pasynUser, epicsUInt32
   epicsTimeStamp timeStamp; getTimeStamp(&timeStamp);
   asynStatus status = asynSuccess;
   epicsUInt32 vmeAddr = 0;
+  epicsUInt32 readback = value;
+  bool verify = false;
+
+  if( function < 0 || function >= NUM_ISEGVDS_REGISTERS ) return asynError;
+  const isegVdsRegister& reg = isegVdsRegisters[function];
 
   // Return if function is a read-only parameter
-  if ( function == P_ModStatus   || \
-       function == P_ChanStatus  )
-    return asynSuccess;
+  if ( !( reg.access & ISEGVDS_WRITE ) ) return asynSuccess;
   
   status = getAddress( pasynUser, &addr ); if( status != asynSuccess ) return status;
 
-  cmdIter it = _modcmds.find( function );
-  if( _modcmds.end() == it ) {
-    it = _chancmds.find( function );
-    if( _chancmds.end() == it ) return asynError;
-    vmeAddr += chanAddr[addr];
-  }
-  vmeAddr += it->second;
+  vmeAddr = registerAddress( reg, addr );
+
+  _cacheTime[addr][function].secPastEpoch = 0;
+  verify = ( _cacheMaxAge > 0. && ( reg.access & ISEGVDS_CACHED ) );
 
-  try{
-    _vme->writeRegisterA16D32( _base, vmeAddr, value );
-  } catch( VmeException &e ){
+  epicsTimeStamp start;
+  epicsTimeGetCurrent( &start );
+  VmeMaster::Status vmeStatus = writeRegister( addr, vmeAddr, value, verify, readback );
+  if( vmeStatus ) {
+    _latency[ISEGVDS_STAT_WRITE].addError();
     epicsSnprintf( pasynUser->errorMessage, pasynUser->errorMessageSize, 
                    "%s:%s: function=%d %s",
-                   driverName, functionName, function, e.what() );
+                   driverName, functionName, function, VmeMaster::statusString( vmeStatus ) );
     return asynError;
   }
+  _latency[ISEGVDS_STAT_WRITE].add( start );
+
+  // cache value if verify read returned the written value
+  if( verify && !( ( readback ^ value ) & mask ) ) confirmCache( addr, function );
 
   // update value of parameter
-  status = (asynStatus) setUIntDigitalParam( addr, function, value, mask );
-  status = (asynStatus) callParamCallbacks( addr, addr );
+  status = setBits( addr, function, readback, mask );
+  publishWrite( addr, start );
     
   if( status ) 
     epicsSnprintf( pasynUser->errorMessage, pasynUser->errorMessageSize, 
@@ -195,34 +2555,44 @@ asynStatus drvAsynIsegVds::readFloat64( asynUser *pasynUser, epicsFloat64 *value
   asynStatus status = asynSuccess;
   epicsTimeStamp timeStamp; getTimeStamp(&timeStamp);
   epicsUInt32 vmeAddr = 0;
-  float_t data;
+  epicsUInt32 vmeData = 0;
   
   status = getAddress(pasynUser, &addr); if (status != asynSuccess) return(status);
+  if( function >= P_StatCount && function <= P_LinkContentions ) {
+    publishStatistics();
+    return asynPortDriver::readFloat64( pasynUser, value );
+  }
+  if( function >= P_RampTarget && function <= P_RampMaxDiff ) return asynPortDriver::readFloat64( pasynUser, value );
+  if( function >= P_ModStatusOr && function <= P_PortChansRamping ) return asynPortDriver::readFloat64( pasynUser, value );
+  if( function < 0 || function >= NUM_ISEGVDS_REGISTERS ) return asynError;
 
-  cmdIter it = _modcmds.find( function );
-  if( _modcmds.end() == it ) {
-    it = _chancmds.find( function );
-    if( _chancmds.end() == it ) return asynError;
-    vmeAddr += chanAddr[addr];
+  if( isCacheValid( addr, function ) ) {
+    status = (asynStatus) getDoubleParam( addr, function, value );
+    pasynUser->timestamp = timeStamp;
+    return status;
   }
-  vmeAddr += it->second;
+  if( fromSnapshot( addr, function, pasynUser->timestamp ) )
+    return (asynStatus) getDoubleParam( addr, function, value );
 
-  try {
-    epicsUInt32 vmeData = _vme->readRegisterA16D32( _base, vmeAddr );
-    data.ival = vmeData;
-  } catch( VmeException &e ){
+  vmeAddr = registerAddress( isegVdsRegisters[function], addr );
+
+  epicsTimeStamp start;
+  epicsTimeGetCurrent( &start );
+  VmeMaster::Status vmeStatus = _vme->tryRead( VmeMaster::A16, VmeMaster::WIDTH32,
+                                                _bases[addr / ISEGVDS_NCHANNELS] + vmeAddr, vmeData );
+  if( vmeStatus ) {
+    _latency[ISEGVDS_STAT_READ].addError();
     epicsSnprintf( pasynUser->errorMessage, pasynUser->errorMessageSize, 
                    "%s:%s: function=%d %s",
-                   driverName, functionName, function, e.what() );
+                   driverName, functionName, function, VmeMaster::statusString( vmeStatus ) );
     return asynError;
   }
+  _latency[ISEGVDS_STAT_READ].add( start );
 
-  // convert current from A to uA
-  if ( function == P_ChanImom || function == P_ChanIset ) data.fval *= 1.e6;
-
-  status = setDoubleParam( addr, function, data.fval );
+  confirmCache( addr, function );
+  updateParam( addr, function, vmeData );
   status = (asynStatus) getDoubleParam(addr, function, value);
-  pasynUser->timestamp = timeStamp;
+  pasynUser->timestamp = start;
   if (status) 
     epicsSnprintf( pasynUser->errorMessage, pasynUser->errorMessageSize, 
                    "%s:%s: status=%d, function=%d, value=%f", 
@@ -250,43 +2620,63 @@ asynStatus drvAsynIsegVds::writeFloat64( asynUser *pasynUser, epicsFloat64 value
   asynStatus status = asynSuccess;
   int addr = 0;
   epicsUInt32 vmeAddr = 0;
-  float_t vmeData; vmeData.fval = (epicsFloat32)value;
-
-  // Return if function is a read-only parameter
-  if ( function == P_VMax        || \
-       function == P_IMax        || \
-       function == P_SupplyP5    || \
-       function == P_SupplyP12   || \
-       function == P_SupplyN12   || \
-       function == P_Temperature || \
-       function == P_ChanVmom    || \
-       function == P_ChanImom )
-    return asynSuccess;
+  epicsUInt32 readback = 0;
+  bool verify = false;
+  float_t vmeData;
 
   status = getAddress( pasynUser, &addr ); if ( status != asynSuccess ) return status;
+  if( function >= P_RampTarget && function <= P_RampMaxDiff ) {
+    if( P_RampTarget == function ) {
+      _rampTarget[addr]  = value;
+      _rampPending[addr] = true;
+    } else {
+      if( value < 0. ) return asynError;
+      if( P_RampSpeed == function ) _rampSpeed = value;
+      else                          _rampMaxDiff = value;
+    }
+    setDoubleParam( addr, function, value );
+    return (asynStatus) callParamCallbacks( addr, addr );
+  }
+  if( function < 0 || function >= NUM_ISEGVDS_REGISTERS ) return asynError;
+  const isegVdsRegister& reg = isegVdsRegisters[function];
+
+  // Return if function is a read-only parameter
+  if ( !( reg.access & ISEGVDS_WRITE ) ) return asynSuccess;
 
-  // convert current from A to uA
-  if ( function == P_ChanIset ) vmeData.fval *= 1.e-6;
+  // convert from engineering unit to register unit (e.g. uA to A)
+  vmeData.fval = (epicsFloat32)( value / reg.scale );
 
-  cmdIter it = _modcmds.find( function );
-  if( _modcmds.end() == it ) {
-    it = _chancmds.find( function );
-    if( _chancmds.end() == it ) return asynError;
-    vmeAddr += chanAddr[addr];
+  if( _writeWindows[function] > 0. ) {
+    // published with the readback at the end of the window
+    queueWrite( addr, function, vmeData.ival );
+    return setDoubleParam( addr, function, value );
   }
-  vmeAddr += it->second;
 
-  try{
-    _vme->writeRegisterA16D32( _base, vmeAddr, vmeData.ival );
-  } catch( VmeException &e ){
+  vmeAddr = registerAddress( reg, addr );
+
+  _cacheTime[addr][function].secPastEpoch = 0;
+  verify = ( _cacheMaxAge > 0. && ( reg.access & ISEGVDS_CACHED ) );
+
+  epicsTimeStamp start;
+  epicsTimeGetCurrent( &start );
+  VmeMaster::Status vmeStatus = writeRegister( addr, vmeAddr, vmeData.ival, verify, readback );
+  if( vmeStatus ) {
+    _latency[ISEGVDS_STAT_WRITE].addError();
     epicsSnprintf( pasynUser->errorMessage, pasynUser->errorMessageSize, 
                    "%s:%s: function=%d %s",
-                   driverName, functionName, function, e.what() );
+                   driverName, functionName, function, VmeMaster::statusString( vmeStatus ) );
     return asynError;
   }
+  _latency[ISEGVDS_STAT_WRITE].add( start );
 
-  status = setDoubleParam( addr, function, value );
-  status = (asynStatus)callParamCallbacks( addr, addr );
+  if( verify ) {
+    // cache value if verify read returned the written value
+    if( readback == vmeData.ival ) confirmCache( addr, function );
+    updateParam( addr, function, readback );
+  } else {
+    status = setDoubleParam( addr, function, value );
+  }
+  publishWrite( addr, start );
   if ( status ) 
     asynPrint( pasynUser, ASYN_TRACE_ERROR, 
                "%s:%s: error, status=%d function=%d, value=%f\n", 
@@ -298,19 +2688,271 @@ asynStatus drvAsynIsegVds::writeFloat64( asynUser *pasynUser, epicsFloat64 value
   return status;
 }
 
+//------------------------------------------------------------------------------
+//! @brief   Channel register behind an array parameter
+//!
+//! @return  index of the channel register, -1 if function is no array parameter
+//------------------------------------------------------------------------------
+int drvAsynIsegVds::arrayElement( int function ) const {
+  switch( function ) {
+    case P_VSetAll:       return P_ChanVset;
+    case P_VMomAll:       return P_ChanVmom;
+    case P_IMomAll:       return P_ChanImom;
+    case P_ChanStatusAll: return P_ChanStatus;
+    default:              return -1;
+  }
+}
+
+//------------------------------------------------------------------------------
+//! @brief   Read one channel register of all channels of a module
+//!
+//! The reads are submitted as one transaction list. The parameters of the
+//! channels are updated with the results.
+//!
+//! @param   [in]  addr      asyn address of the module
+//! @param   [in]  function  index of the channel register
+//! @param   [out] vmeData   raw register content, one word per channel
+//!
+//! @return  status of the VME transfer, the parameters are only updated on success
+//------------------------------------------------------------------------------
+VmeMaster::Status drvAsynIsegVds::readChannels( int addr, int function, epicsUInt32* vmeData ) {
+  const isegVdsRegister& reg = isegVdsRegisters[function];
+  const int modAddr = addr - addr % ISEGVDS_NCHANNELS;
+  const epicsUInt32 base = _bases[addr / ISEGVDS_NCHANNELS];
+
+  VmeMaster::TransactionList list;
+  for( int ch = 0; ch < ISEGVDS_NCHANNELS; ++ch )
+    list.push_back( VmeMaster::readCycle( VmeMaster::A16, VmeMaster::WIDTH32,
+                                          base + registerAddress( reg, ch ) ) );
+  size_t executed;
+  VmeMaster::Status status = _vme->tryExecute( list, executed );
+  if( status ) return status;
+
+  for( int ch = 0; ch < ISEGVDS_NCHANNELS; ++ch ) {
+    vmeData[ch] = list[ch].value;
+    confirmCache( modAddr + ch, function );
+    updateParam( modAddr + ch, function, vmeData[ch] );
+  }
+  return VmeMaster::SUCCESS;
+}
+
+//------------------------------------------------------------------------------
+//! @brief   Called when asyn clients call pasynFloat64Array->read().
+//!
+//! Reads the register of all channels of the module in one VME transaction.
+//!
+//! @param   [in]  pasynUser  pasynUser structure that encodes the reason and address
+//! @param   [out] value      Array receiving one value per channel
+//! @param   [in]  nElements  Size of the array
+//! @param   [out] nIn        Number of values returned
+//!
+//! @return  in case of no error occured asynSuccess is returned. Otherwise
+//!          asynError or asynTimeout is returned. A error message is stored
+//!          in pasynUser->errorMessage.
+//------------------------------------------------------------------------------
+asynStatus drvAsynIsegVds::readFloat64Array( asynUser *pasynUser, epicsFloat64 *value, size_t nElements, size_t *nIn ) {
+  static const char *functionName = "readFloat64Array";
+  int function = pasynUser->reason;
+  int addr = 0;
+  epicsUInt32 vmeData[ISEGVDS_NCHANNELS];
+
+  asynStatus status = getAddress( pasynUser, &addr ); if( status != asynSuccess ) return status;
+  if( P_VMomHistory == function || P_IMomHistory == function ) {
+    const std::vector<HistoryBuffer>& history = ( P_VMomHistory == function ) ? _vmomHistory : _imomHistory;
+    *nIn = history[addr].copy( value, nElements );
+    return asynSuccess;
+  }
+  int element = arrayElement( function );
+  if( element < 0 || asynParamFloat64 != isegVdsRegisters[element].type ) return asynError;
+
+  const int modAddr = addr - addr % ISEGVDS_NCHANNELS;
+  size_t n = ( nElements < ISEGVDS_NCHANNELS ) ? nElements : ISEGVDS_NCHANNELS;
+  if( fromSnapshot( modAddr, element, pasynUser->timestamp ) ) {
+    for( size_t ch = 0; ch < n; ++ch ) getDoubleParam( modAddr + ch, element, &value[ch] );
+    *nIn = n;
+    return asynSuccess;
+  }
+
+  epicsTimeStamp start;
+  epicsTimeGetCurrent( &start );
+  VmeMaster::Status vmeStatus = readChannels( addr, element, vmeData );
+  if( vmeStatus ) {
+    _latency[ISEGVDS_STAT_ARRAY].addError();
+    epicsSnprintf( pasynUser->errorMessage, pasynUser->errorMessageSize, 
+                   "%s:%s: function=%d %s",
+                   driverName, functionName, function, VmeMaster::statusString( vmeStatus ) );
+    return asynError;
+  }
+  _latency[ISEGVDS_STAT_ARRAY].add( start );
+
+  for( size_t ch = 0; ch < n; ++ch ) value[ch] = toDouble( element, vmeData[ch] );
+  *nIn = n;
+  pasynUser->timestamp = start;
+
+  asynPrint( pasynUser, ASYN_TRACEIO_DRIVER, 
+             "%s:%s: function=%d, %lu values\n", 
+             driverName, functionName, function, (unsigned long)n );
+  return asynSuccess;
+}
+
+//------------------------------------------------------------------------------
+//! @brief   Called when asyn clients call pasynFloat64Array->write().
+//!
+//! Writes the setpoints of all channels of the module in one VME transaction,
+//! including the verify reads if caching is enabled. Channels beyond
+//! nElements are not touched.
+//!
+//! @param   [in]  pasynUser  pasynUser structure that encodes the reason and address
+//! @param   [in]  value      Array with one value per channel
+//! @param   [in]  nElements  Number of values
+//!
+//! @return  in case of no error occured asynSuccess is returned. Otherwise
+//!          asynError or asynTimeout is returned. A error message is stored
+//!          in pasynUser->errorMessage.
+//------------------------------------------------------------------------------
+asynStatus drvAsynIsegVds::writeFloat64Array( asynUser *pasynUser, epicsFloat64 *value, size_t nElements ) {
+  static const char *functionName = "writeFloat64Array";
+  int function = pasynUser->reason;
+  int addr = 0;
+
+  asynStatus status = getAddress( pasynUser, &addr ); if( status != asynSuccess ) return status;
+  int element = arrayElement( function );
+  if( element < 0 || asynParamFloat64 != isegVdsRegisters[element].type ) return asynError;
+  const isegVdsRegister& reg = isegVdsRegisters[element];
+
+  // Return if function is a read-only parameter
+  if ( !( reg.access & ISEGVDS_WRITE ) ) return asynSuccess;
+
+  const int modAddr = addr - addr % ISEGVDS_NCHANNELS;
+  const epicsUInt32 base = _bases[addr / ISEGVDS_NCHANNELS];
+  const size_t n = ( nElements < ISEGVDS_NCHANNELS ) ? nElements : ISEGVDS_NCHANNELS;
+  const bool verify = ( _cacheMaxAge > 0. && ( reg.access & ISEGVDS_CACHED ) );
+
+  VmeMaster::TransactionList list;
+  for( size_t ch = 0; ch < n; ++ch ) {
+    float_t vmeData;
+    vmeData.fval = (epicsFloat32)( value[ch] / reg.scale );
+    list.push_back( VmeMaster::writeCycle( VmeMaster::A16, VmeMaster::WIDTH32,
+                                           base + registerAddress( reg, ch ), vmeData.ival ) );
+    _cacheTime[modAddr + ch][element].secPastEpoch = 0;
+  }
+  if( verify ) {
+    for( size_t ch = 0; ch < n; ++ch )
+      list.push_back( VmeMaster::readCycle( VmeMaster::A16, VmeMaster::WIDTH32, list[ch].address ) );
+  }
+
+  epicsTimeStamp start;
+  epicsTimeGetCurrent( &start );
+  size_t executed;
+  VmeMaster::Status vmeStatus = _vme->tryExecute( list, executed );
+  if( vmeStatus ) {
+    _latency[ISEGVDS_STAT_ARRAY].addError();
+    epicsSnprintf( pasynUser->errorMessage, pasynUser->errorMessageSize, 
+                   "%s:%s: function=%d %s after %lu of %lu cycles",
+                   driverName, functionName, function, VmeMaster::statusString( vmeStatus ),
+                   (unsigned long)executed, (unsigned long)list.size() );
+    return asynError;
+  }
+  _latency[ISEGVDS_STAT_ARRAY].add( start );
+
+  beginCycle( start );
+  for( size_t ch = 0; ch < n; ++ch ) {
+    if( verify ) {
+      epicsUInt32 readback = list[n + ch].value;
+      // cache value if verify read returned the written value
+      if( readback == list[ch].value ) confirmCache( modAddr + ch, element );
+      updateParam( modAddr + ch, element, readback );
+    } else {
+      setDoubleParam( modAddr + ch, element, value[ch] );
+    }
+    markDirty( modAddr + ch );
+  }
+  endCycle();
+
+  asynPrint( pasynUser, ASYN_TRACEIO_DRIVER, 
+             "%s:%s: function=%d, %lu values\n", 
+             driverName, functionName, function, (unsigned long)n );
+  return asynSuccess;
+}
+
+//------------------------------------------------------------------------------
+//! @brief   Called when asyn clients call pasynInt32Array->read().
+//!
+//! Reads the status register of all channels of the module in one VME
+//! transaction.
+//!
+//! @param   [in]  pasynUser  pasynUser structure that encodes the reason and address
+//! @param   [out] value      Array receiving one value per channel
+//! @param   [in]  nElements  Size of the array
+//! @param   [out] nIn        Number of values returned
+//!
+//! @return  in case of no error occured asynSuccess is returned. Otherwise
+//!          asynError or asynTimeout is returned. A error message is stored
+//!          in pasynUser->errorMessage.
+//------------------------------------------------------------------------------
+asynStatus drvAsynIsegVds::readInt32Array( asynUser *pasynUser, epicsInt32 *value, size_t nElements, size_t *nIn ) {
+  static const char *functionName = "readInt32Array";
+  int function = pasynUser->reason;
+  int addr = 0;
+  epicsUInt32 vmeData[ISEGVDS_NCHANNELS];
+
+  asynStatus status = getAddress( pasynUser, &addr ); if( status != asynSuccess ) return status;
+  int element = arrayElement( function );
+  if( element < 0 || asynParamUInt32Digital != isegVdsRegisters[element].type ) return asynError;
+
+  const int modAddr = addr - addr % ISEGVDS_NCHANNELS;
+  size_t n = ( nElements < ISEGVDS_NCHANNELS ) ? nElements : ISEGVDS_NCHANNELS;
+  if( fromSnapshot( modAddr, element, pasynUser->timestamp ) ) {
+    for( size_t ch = 0; ch < n; ++ch ) {
+      epicsUInt32 word = 0;
+      getUIntDigitalParam( modAddr + ch, element, &word, 0xffffffff );
+      value[ch] = word;
+    }
+    *nIn = n;
+    return asynSuccess;
+  }
+
+  epicsTimeStamp start;
+  epicsTimeGetCurrent( &start );
+  VmeMaster::Status vmeStatus = readChannels( addr, element, vmeData );
+  if( vmeStatus ) {
+    _latency[ISEGVDS_STAT_ARRAY].addError();
+    epicsSnprintf( pasynUser->errorMessage, pasynUser->errorMessageSize, 
+                   "%s:%s: function=%d %s",
+                   driverName, functionName, function, VmeMaster::statusString( vmeStatus ) );
+    return asynError;
+  }
+  _latency[ISEGVDS_STAT_ARRAY].add( start );
+
+  for( size_t ch = 0; ch < n; ++ch ) value[ch] = vmeData[ch];
+  *nIn = n;
+  pasynUser->timestamp = start;
+
+  asynPrint( pasynUser, ASYN_TRACEIO_DRIVER, 
+             "%s:%s: function=%d, %lu values\n", 
+             driverName, functionName, function, (unsigned long)n );
+  return asynSuccess;
+}
+
 //------------------------------------------------------------------------------
 //! @brief   Constructor for the drvAsynIsegVds class.
 //!          Calls constructor for the asynPortDriver base class.
 //!
-//! @param   [in]  portName    The name of the asynPortDriver to be created.
-//! @param   [in]  BA          The base address
+//! @param   [in]  portName       The name of the asynPortDriver to be created.
+//! @param   [in]  baseAddresses  The base addresses of all modules served by this port
+//! @param   [in]  pollPeriod     Interval of the background poller in seconds.
+//!                               The poller is disabled if pollPeriod <= 0.
+//! @param   [in]  link           Name of the VME master (NULL or empty: default link)
 //------------------------------------------------------------------------------
-drvAsynIsegVds::drvAsynIsegVds( const char *portName, const int BA ) 
+drvAsynIsegVds::drvAsynIsegVds( const char *portName, const std::vector<epicsUInt32>& baseAddresses,
+                                const double pollPeriod, const char *link ) 
   : asynPortDriver( portName, 
-                    8, // maxAddr
+                    baseAddresses.size() * ISEGVDS_NCHANNELS + ISEGVDS_NUM_STATS, // maxAddr
                     NUM_ISEGVDS_PARAMS,
-                    asynCommonMask | asynInt32Mask | asynUInt32DigitalMask | asynFloat64Mask | asynDrvUserMask, // Interface mask
-                    asynCommonMask | asynInt32Mask | asynUInt32DigitalMask | asynFloat64Mask,  // Interrupt mask
+                    asynCommonMask | asynInt32Mask | asynUInt32DigitalMask | asynFloat64Mask |
+                    asynInt32ArrayMask | asynFloat64ArrayMask | asynDrvUserMask, // Interface mask
+                    asynCommonMask | asynInt32Mask | asynUInt32DigitalMask | asynFloat64Mask |
+                    asynInt32ArrayMask | asynFloat64ArrayMask,  // Interrupt mask
                     ASYN_CANBLOCK | ASYN_MULTIDEVICE, // asynFlags.
                     1, // Autoconnect
                     0, // Default priority
@@ -319,71 +2961,160 @@ drvAsynIsegVds::drvAsynIsegVds( const char *portName, const int BA )
   static const char *functionName = "drvAsynIsegVds";
   
   _deviceName = epicsStrDup( portName );
-  _base       = BA;
-  _vme        = VmeMaster::getInstance(); 
+  _bases      = baseAddresses;
+  _chanAddrs  = baseAddresses.size() * ISEGVDS_NCHANNELS;
+  _pollPeriod = pollPeriod;
+  _slowPeriod = pollPeriod;
+  _pollEvent  = epicsEventMustCreate( epicsEventEmpty );
+  _pollThread = 0;
+  _linkDown   = false;
+  _configured = false;
+  _portUser   = 0;
+  _eventPeriod = 0.;
+  _irqLevel    = 0;
+  _eventThread = 0;
+  _cacheMaxAge = 0.;
+  _initPhase  = true;
+  _cycleDepth = 0;
+  _coalesceWrites = false;
+  _snapshotMode = false;
+  _windowsMapped = false;
+  _timeEvent    = 0;
+  _historySize   = 0;
+  _historyPeriod = 0.;
+  _rampRunning = false;
+  _rampSpeed   = 10.;
+  _rampMaxDiff = 0.;
+  _imageFile   = 0;
+  _imagePeriod = 0.;
+  _imageLock   = epicsMutexMustCreate();
+  _lockOwner   = 0;
+  _lockDepth   = 0;
+  _writeTimer  = 0;
+  _writeDue.secPastEpoch = 0;
+  _writeDue.nsec         = 0;
+  _writesCoalesced = 0;
+  for( int lane = 0; lane < ISEGVDS_NUM_LANES; ++lane ) {
+    _laneWaiting[lane] = 0;
+    _laneEvents[lane]  = epicsEventMustCreate( epicsEventEmpty );
+  }
+  _vme        = VmeMaster::getInstance( link ); 
   if( !_vme ) {
-    fprintf( stderr, "\033[31;1m %s:%s: Could not find VmeMastet. \033[0m \n",
-             driverName, functionName );
+    fprintf( stderr, "\033[31;1m %s:%s: Could not find VME master %s. \033[0m \n",
+             driverName, functionName, ( link && link[0] ) ? link : "(default)" );
     return;
   }
 
-  // Module data
-  createParam( P_ISEGVDS_MODSTATUS_STRING,         asynParamUInt32Digital, &P_ModStatus );
-  createParam( P_ISEGVDS_MODEVTSTATUS_STRING,      asynParamUInt32Digital, &P_ModEvtStatus );
-  createParam( P_ISEGVDS_MODEVTMASK_STRING,        asynParamUInt32Digital, &P_ModEvtMask );
-  createParam( P_ISEGVDS_MODCTRL_STRING,           asynParamUInt32Digital, &P_ModCtrl );
-  createParam( P_ISEGVDS_MODEVTCHANSTATUS_STRING,  asynParamUInt32Digital, &P_ModEvtChanStatus );
-  createParam( P_ISEGVDS_MODEVTCHANMASK_STRING,    asynParamUInt32Digital, &P_ModEvtChanMask );
-  createParam( P_ISEGVDS_MODEVTGRPSTATUS_STRING,   asynParamUInt32Digital, &P_ModEvtGrpStatus );
-  createParam( P_ISEGVDS_MODEVTGRPMASK_STRING,     asynParamUInt32Digital, &P_ModEvtGrpMask );
-  createParam( P_ISEGVDS_VRAMP_STRING,             asynParamFloat64,       &P_VRamp );
-  createParam( P_ISEGVDS_CRAMP_STRING,             asynParamFloat64,       &P_CRamp );
-  createParam( P_ISEGVDS_VMAX_STRING,              asynParamFloat64,       &P_VMax );
-  createParam( P_ISEGVDS_IMAX_STRING,              asynParamFloat64,       &P_IMax );
-  createParam( P_ISEGVDS_SUPPLYP5_STRING,          asynParamFloat64,       &P_SupplyP5 );
-  createParam( P_ISEGVDS_SUPPLYP12_STRING,         asynParamFloat64,       &P_SupplyP12 );
-  createParam( P_ISEGVDS_SUPPLYN12_STRING,         asynParamFloat64,       &P_SupplyN12 );
-  createParam( P_ISEGVDS_TEMPERATURE_STRING,       asynParamFloat64,       &P_Temperature );
-  // channel data
-  createParam( P_ISEGVDS_CHANSTATUS_STRING,        asynParamUInt32Digital, &P_ChanStatus );
-  createParam( P_ISEGVDS_CHANEVTSTATUS_STRING,     asynParamUInt32Digital, &P_ChanEvtStatus );
-  createParam( P_ISEGVDS_CHANEVTMASK_STRING,       asynParamUInt32Digital, &P_ChanEvtMask );
-  createParam( P_ISEGVDS_CHANCTRL_STRING,          asynParamUInt32Digital, &P_ChanCtrl );
-  createParam( P_ISEGVDS_CHANVSET_STRING,          asynParamFloat64,       &P_ChanVset );
-  createParam( P_ISEGVDS_CHANISET_STRING,          asynParamFloat64,       &P_ChanIset );
-  createParam( P_ISEGVDS_CHANVMOM_STRING,          asynParamFloat64,       &P_ChanVmom );
-  createParam( P_ISEGVDS_CHANIMOM_STRING,          asynParamFloat64,       &P_ChanImom );
-  createParam( P_ISEGVDS_CHANVBOUNDS_STRING,       asynParamFloat64,       &P_ChanVBounds );
-  createParam( P_ISEGVDS_CHANIBOUNDS_STRING,       asynParamFloat64,       &P_ChanIBounds );
-
-  _modcmds.insert( std::make_pair( P_ModStatus,         0x0000 ) );
-  _modcmds.insert( std::make_pair( P_ModEvtStatus,      0x0004 ) );
-  _modcmds.insert( std::make_pair( P_ModEvtMask,        0x0008 ) );
-  _modcmds.insert( std::make_pair( P_ModCtrl,           0x000c ) );
-  _modcmds.insert( std::make_pair( P_ModEvtChanStatus,  0x0010 ) );
-  _modcmds.insert( std::make_pair( P_ModEvtChanMask,    0x0014 ) );
-  _modcmds.insert( std::make_pair( P_ModEvtGrpStatus,   0x0018 ) );
-  _modcmds.insert( std::make_pair( P_ModEvtGrpMask,     0x001c ) );
-  _modcmds.insert( std::make_pair( P_VRamp,             0x0020 ) );
-  _modcmds.insert( std::make_pair( P_CRamp,             0x0024 ) );
-  _modcmds.insert( std::make_pair( P_VMax,              0x0028 ) );
-  _modcmds.insert( std::make_pair( P_IMax,              0x002c ) );
-  _modcmds.insert( std::make_pair( P_SupplyP5,          0x0040 ) );
-  _modcmds.insert( std::make_pair( P_SupplyP12,         0x0044 ) );
-  _modcmds.insert( std::make_pair( P_SupplyN12,         0x0048 ) );
-  _modcmds.insert( std::make_pair( P_Temperature,       0x004c ) );
-
-  _chancmds.insert( std::make_pair( P_ChanStatus,        0x0000 ) );
-  _chancmds.insert( std::make_pair( P_ChanEvtStatus,     0x0004 ) );
-  _chancmds.insert( std::make_pair( P_ChanEvtMask,       0x0008 ) );
-  _chancmds.insert( std::make_pair( P_ChanCtrl,          0x000c ) );
-  _chancmds.insert( std::make_pair( P_ChanVset,          0x0010 ) );
-  _chancmds.insert( std::make_pair( P_ChanIset,          0x0014 ) );
-  _chancmds.insert( std::make_pair( P_ChanVmom,          0x0018 ) );
-  _chancmds.insert( std::make_pair( P_ChanImom,          0x001c ) );
-  _chancmds.insert( std::make_pair( P_ChanVBounds,       0x0020 ) );
-  _chancmds.insert( std::make_pair( P_ChanIBounds,       0x0024 ) );
+  // Create parameters from the descriptor tables, the parameter index
+  // has to match the position in the tables. The size of the parameter
+  // library passed to asynPortDriver is derived from the same enum.
+  STATIC_ASSERT( numIsegVdsRegisters == NUM_ISEGVDS_REGISTERS );
+  STATIC_ASSERT( NUM_ISEGVDS_REGISTERS + numIsegVdsParameters == NUM_ISEGVDS_PARAMETERS );
+  _blockWords[ISEGVDS_MODULE]  = 0;
+  _blockWords[ISEGVDS_CHANNEL] = 0;
+  for( int i = 0; i < numIsegVdsRegisters; ++i ) {
+    const isegVdsRegister& reg = isegVdsRegisters[i];
+    int index = -1;
+    if( asynSuccess != createParam( reg.name, reg.type, &index ) || index != i ) {
+      fprintf( stderr, "\033[31;1m %s:%s: Could not create parameter %s. \033[0m \n",
+               driverName, functionName, reg.name );
+      return;
+    }
+    _blockParams[reg.scope].push_back( i );
+    if( reg.offset / 4 + 1 > _blockWords[reg.scope] ) _blockWords[reg.scope] = reg.offset / 4 + 1;
+  }
+  for( int scope = ISEGVDS_MODULE; scope <= ISEGVDS_CHANNEL; ++scope ) {
+    _blockScale[scope].assign( _blockWords[scope], 0. );
+    for( size_t i = 0; i < _blockParams[scope].size(); ++i ) {
+      const isegVdsRegister& reg = isegVdsRegisters[_blockParams[scope][i]];
+      if( asynParamFloat64 == reg.type ) _blockScale[scope][reg.offset / 4] = reg.scale;
+    }
+  }
+  _modValues.assign( _blockWords[ISEGVDS_MODULE], 0. );
+  _chanValues.assign( _blockWords[ISEGVDS_CHANNEL] * ISEGVDS_NCHANNELS, 0. );
+
+  // Array, history, ramp and statistics parameters follow the register parameters
+  for( int i = 0; i < numIsegVdsParameters; ++i ) {
+    int index = -1;
+    if( asynSuccess != createParam( isegVdsParameters[i].name, isegVdsParameters[i].type, &index ) ||
+        index != NUM_ISEGVDS_REGISTERS + i ) {
+      fprintf( stderr, "\033[31;1m %s:%s: Could not create parameter %s. \033[0m \n",
+               driverName, functionName, isegVdsParameters[i].name );
+      return;
+    }
+  }
+
+  _deadbands.assign( NUM_ISEGVDS_REGISTERS, 0. );
+  isegVdsAggregate none;
+  clearAggregate( none );
+  _moduleAggregate.assign( _bases.size(), none );
+  _writeWindows.assign( NUM_ISEGVDS_REGISTERS, 0. );
+  _modImage.resize( _bases.size() );
+  _chanImage.resize( _chanAddrs );
+  _chanActive.assign( _chanAddrs, false );
+  _dirty.assign( maxAddr, false );
+  epicsTimeStamp due = { 0, 0 };
+  _nextFullPoll.assign( _bases.size(), due );
+  _snapshotTime.assign( _bases.size(), due );
+  _nextHistory = due;
+  _vmomHistory.resize( _chanAddrs );
+  _imomHistory.resize( _chanAddrs );
+  _historyCaptured.assign( _chanAddrs, false );
+  _historyTripped.assign( _chanAddrs, false );
+  _lastRamp = due;
+  _nextImage = due;
+  _rampTarget.assign( _chanAddrs, 0. );
+  _rampSet.assign( _chanAddrs, 0. );
+  _rampPending.assign( _chanAddrs, false );
+  _rampActive.assign( _chanAddrs, false );
+  _rampUp.assign( _chanAddrs, true );
+  setDoubleParam( 0, P_RampSpeed,   _rampSpeed );
+  setDoubleParam( 0, P_RampMaxDiff, _rampMaxDiff );
+  setIntegerParam( 0, P_RampRun, 0 );
+  _snapshotList.assign( ISEGVDS_NCHANNELS * _blockWords[ISEGVDS_CHANNEL],
+                        VmeMaster::readCycle( VmeMaster::A16, VmeMaster::WIDTH32, 0 ) );
+  epicsTimeStamp unconfirmed = { 0, 0 };
+  _cacheTime.assign( _chanAddrs, std::vector<epicsTimeStamp>( NUM_ISEGVDS_REGISTERS, unconfirmed ) );
+  _moduleUp.assign( _bases.size(), true );
+  _retryDelay.assign( _bases.size() + 1, retryMinDelay );
+  _nextRetry.assign( _bases.size() + 1, due );
+
+  // let the VME master map the module windows if it can
+  _windowsMapped = !_bases.empty();
+  for( size_t module = 0; module < _bases.size(); ++module )
+    _windowsMapped = _vme->mapWindow( VmeMaster::A16, _bases[module], moduleWindow ) && _windowsMapped;
+
+  // register writes of asyn clients lock the port in the write lane
+  interposeWrites();
+
+  // asyn users to signal link and module states to asynManager
+  _portUser = pasynManager->createAsynUser( 0, 0 );
+  pasynManager->connectDevice( _portUser, portName, -1 );
+  for( int addr = 0; addr < _chanAddrs; ++addr ) {
+    asynUser *pasynUser = pasynManager->createAsynUser( 0, 0 );
+    pasynManager->connectDevice( pasynUser, portName, addr );
+    _devUsers.push_back( pasynUser );
+  }
+
+  // nothing below may run on a port whose setup was aborted above
+  _configured = true;
 
+  // records read their initial values from the parameters seeded at iocInit
+  if( drivers.empty() ) initHookRegister( initHookC );
+  drivers.push_back( this );
+
+  if( _pollPeriod > 0. ) {
+    char threadName[100];
+    epicsSnprintf( threadName, sizeof( threadName ), "%sPoller", portName );
+    _pollThread = epicsThreadCreate( threadName,
+                                     epicsThreadPriorityMedium,
+                                     epicsThreadGetStackSize( epicsThreadStackMedium ),
+                                     (EPICSTHREADFUNC)pollerThreadC,
+                                     this );
+    if( !_pollThread )
+      fprintf( stderr, "\033[31;1m %s:%s: Could not create poller thread. \033[0m \n",
+               driverName, functionName );
+  }
 }
 
 // Configuration routines. Called directly, or from the iocsh function below
@@ -394,20 +3125,334 @@ extern "C" {
   //!          for the drvAsynIsegVds class.
   //!
   //! @param  [in]  portName The name of the asyn port driver to be created.
-  //! @param  [in]  BA       RAM Base address of the ISEG VDS module
+  //! @param  [in]  BA         RAM Base address of the ISEG VDS module
+  //! @param  [in]  pollPeriod Interval of background poller in seconds (0: no poller)
+  //! @param  [in]  link       Name of the VME master (empty: default link)
   //----------------------------------------------------------------------------
-  int drvAsynIsegVdsConfigure( const char *portName, const int BA ) {
-    new drvAsynIsegVds( portName, BA );
-    return( asynSuccess );
+  int drvAsynIsegVdsConfigure( const char *portName, const int BA, const double pollPeriod,
+                               const char *link ) {
+    drvAsynIsegVds *pDrv = new drvAsynIsegVds( portName, std::vector<epicsUInt32>( 1, BA ), pollPeriod, link );
+    return( pDrv->isConfigured() ? asynSuccess : asynError );
   }
-  static const iocshArg initIsegVdsArg0 = { "portName", iocshArgString };
-  static const iocshArg initIsegVdsArg1 = { "BA",       iocshArgInt };
-  static const iocshArg * const initIsegVdsArgs[] = { &initIsegVdsArg0, &initIsegVdsArg1 };
-  static const iocshFuncDef initIsegVdsFuncDef = { "drvAsynIsegVdsConfigure", 2, initIsegVdsArgs };
+  static const iocshArg initIsegVdsArg0 = { "portName",   iocshArgString };
+  static const iocshArg initIsegVdsArg1 = { "BA",         iocshArgInt };
+  static const iocshArg initIsegVdsArg2 = { "pollPeriod", iocshArgDouble };
+  static const iocshArg initIsegVdsArg3 = { "link",       iocshArgString };
+  static const iocshArg * const initIsegVdsArgs[] = { &initIsegVdsArg0, &initIsegVdsArg1, &initIsegVdsArg2,
+                                                      &initIsegVdsArg3 };
+  static const iocshFuncDef initIsegVdsFuncDef = { "drvAsynIsegVdsConfigure", 4, initIsegVdsArgs };
   static void initIsegVdsCallFunc( const iocshArgBuf *args ) {
-    drvAsynIsegVdsConfigure( args[0].sval, args[1].ival );
+    drvAsynIsegVdsConfigure( args[0].sval, args[1].ival, args[2].dval, args[3].sval );
+  }
+
+  //----------------------------------------------------------------------------
+  //! @brief   EPICS iocsh callable function to call constructor
+  //!          for the drvAsynIsegVds class serving several modules.
+  //!
+  //! Module m of the list is served at the asyn addresses
+  //! m * 8 (module registers and channel 0) to m * 8 + 7.
+  //!
+  //! @param  [in]  portName      The name of the asyn port driver to be created.
+  //! @param  [in]  baseAddresses Base addresses of the modules, separated by
+  //!                             comma or blanks (e.g. "0x4000,0x4400")
+  //! @param  [in]  pollPeriod    Interval of background poller in seconds (0: no poller)
+  //! @param  [in]  link          Name of the VME master (empty: default link)
+  //----------------------------------------------------------------------------
+  int drvAsynIsegVdsCrateConfigure( const char *portName, const char *baseAddresses, const double pollPeriod,
+                                    const char *link ) {
+    std::vector<epicsUInt32> bases;
+    const char *pos = baseAddresses;
+    while( pos && *pos ) {
+      if( ',' == *pos || isspace( (unsigned char)*pos ) ) { ++pos; continue; }
+      char *end = 0;
+      unsigned long BA = strtoul( pos, &end, 0 );
+      if( end == pos || BA > 0xffff ) {
+        fprintf( stderr, "drvAsynIsegVdsCrateConfigure: Invalid base address in '%s'\n", baseAddresses );
+        return( asynError );
+      }
+      bases.push_back( BA );
+      pos = end;
+    }
+    if( bases.empty() ) {
+      fprintf( stderr, "drvAsynIsegVdsCrateConfigure: No base address given\n" );
+      return( asynError );
+    }
+    drvAsynIsegVds *pDrv = new drvAsynIsegVds( portName, bases, pollPeriod, link );
+    return( pDrv->isConfigured() ? asynSuccess : asynError );
+  }
+  static const iocshArg initCrateArg0 = { "portName",      iocshArgString };
+  static const iocshArg initCrateArg1 = { "baseAddresses", iocshArgString };
+  static const iocshArg initCrateArg2 = { "pollPeriod",    iocshArgDouble };
+  static const iocshArg initCrateArg3 = { "link",          iocshArgString };
+  static const iocshArg * const initCrateArgs[] = { &initCrateArg0, &initCrateArg1, &initCrateArg2,
+                                                    &initCrateArg3 };
+  static const iocshFuncDef initCrateFuncDef = { "drvAsynIsegVdsCrateConfigure", 4, initCrateArgs };
+  static void initCrateCallFunc( const iocshArgBuf *args ) {
+    drvAsynIsegVdsCrateConfigure( args[0].sval, args[1].sval, args[2].dval, args[3].sval );
   }
   
+  //----------------------------------------------------------------------------
+  //! @brief   EPICS iocsh callable function to set the deadband of a float
+  //!          parameter used by the background poller
+  //!
+  //! @param  [in]  portName  The name of the asyn port driver
+  //! @param  [in]  paramName drvInfo string of the parameter (e.g. "VoltageMeasure")
+  //! @param  [in]  deadband  Deadband in engineering units (0: disabled)
+  //----------------------------------------------------------------------------
+  int drvAsynIsegVdsSetDeadband( const char *portName, const char *paramName, const double deadband ) {
+    drvAsynIsegVds *pDrv = findDriver( portName, "drvAsynIsegVdsSetDeadband" );
+    if( !pDrv ) return( asynError );
+    if( asynSuccess != pDrv->setDeadband( paramName, deadband ) ) {
+      fprintf( stderr, "drvAsynIsegVdsSetDeadband: No float parameter %s\n", paramName );
+      return( asynError );
+    }
+    return( asynSuccess );
+  }
+  static const iocshArg setDeadbandArg0 = { "portName",  iocshArgString };
+  static const iocshArg setDeadbandArg1 = { "paramName", iocshArgString };
+  static const iocshArg setDeadbandArg2 = { "deadband",  iocshArgDouble };
+  static const iocshArg * const setDeadbandArgs[] = { &setDeadbandArg0, &setDeadbandArg1, &setDeadbandArg2 };
+  static const iocshFuncDef setDeadbandFuncDef = { "drvAsynIsegVdsSetDeadband", 3, setDeadbandArgs };
+  static void setDeadbandCallFunc( const iocshArgBuf *args ) {
+    drvAsynIsegVdsSetDeadband( args[0].sval, args[1].sval, args[2].dval );
+  }
+
+  //----------------------------------------------------------------------------
+  //! @brief   EPICS iocsh callable function to coalesce bursts of writes to
+  //!          a float parameter
+  //!
+  //! @param  [in]  portName  The name of the asyn port driver
+  //! @param  [in]  paramName drvInfo string of the parameter (e.g. "VoltageSet")
+  //! @param  [in]  window    Coalescing window in seconds (0: write immediately)
+  //----------------------------------------------------------------------------
+  int drvAsynIsegVdsSetWriteWindow( const char *portName, const char *paramName, const double window ) {
+    drvAsynIsegVds *pDrv = findDriver( portName, "drvAsynIsegVdsSetWriteWindow" );
+    if( !pDrv ) return( asynError );
+    if( asynSuccess != pDrv->setWriteWindow( paramName, window ) ) {
+      fprintf( stderr, "drvAsynIsegVdsSetWriteWindow: No writable float parameter %s\n", paramName );
+      return( asynError );
+    }
+    return( asynSuccess );
+  }
+  static const iocshArg setWriteWindowArg0 = { "portName",  iocshArgString };
+  static const iocshArg setWriteWindowArg1 = { "paramName", iocshArgString };
+  static const iocshArg setWriteWindowArg2 = { "window",    iocshArgDouble };
+  static const iocshArg * const setWriteWindowArgs[] = { &setWriteWindowArg0, &setWriteWindowArg1, &setWriteWindowArg2 };
+  static const iocshFuncDef setWriteWindowFuncDef = { "drvAsynIsegVdsSetWriteWindow", 3, setWriteWindowArgs };
+  static void setWriteWindowCallFunc( const iocshArgBuf *args ) {
+    drvAsynIsegVdsSetWriteWindow( args[0].sval, args[1].sval, args[2].dval );
+  }
+
+  //----------------------------------------------------------------------------
+  //! @brief   EPICS iocsh callable function to enable the cache for setpoints,
+  //!          masks and limits
+  //!
+  //! @param  [in]  portName  The name of the asyn port driver
+  //! @param  [in]  maxAge    Max. age of a cached value in seconds (0: disabled)
+  //----------------------------------------------------------------------------
+  int drvAsynIsegVdsSetCacheAge( const char *portName, const double maxAge ) {
+    drvAsynIsegVds *pDrv = findDriver( portName, "drvAsynIsegVdsSetCacheAge" );
+    if( !pDrv ) return( asynError );
+    pDrv->setCacheMaxAge( maxAge );
+    return( asynSuccess );
+  }
+  static const iocshArg setCacheAgeArg0 = { "portName", iocshArgString };
+  static const iocshArg setCacheAgeArg1 = { "maxAge",   iocshArgDouble };
+  static const iocshArg * const setCacheAgeArgs[] = { &setCacheAgeArg0, &setCacheAgeArg1 };
+  static const iocshFuncDef setCacheAgeFuncDef = { "drvAsynIsegVdsSetCacheAge", 2, setCacheAgeArgs };
+  static void setCacheAgeCallFunc( const iocshArgBuf *args ) {
+    drvAsynIsegVdsSetCacheAge( args[0].sval, args[1].dval );
+  }
+
+  //----------------------------------------------------------------------------
+  //! @brief   EPICS iocsh callable function to coalesce the callbacks of
+  //!          single writes with the next poll cycle
+  //!
+  //! @param  [in]  portName  The name of the asyn port driver
+  //! @param  [in]  enable    1: coalesce, 0: call back on each write
+  //----------------------------------------------------------------------------
+  int drvAsynIsegVdsSetCoalescing( const char *portName, const int enable ) {
+    drvAsynIsegVds *pDrv = findDriver( portName, "drvAsynIsegVdsSetCoalescing" );
+    if( !pDrv ) return( asynError );
+    if( asynSuccess != pDrv->setCoalescing( enable != 0 ) ) {
+      fprintf( stderr, "drvAsynIsegVdsSetCoalescing: No poller on %s\n", portName );
+      return( asynError );
+    }
+    return( asynSuccess );
+  }
+  static const iocshArg setCoalescingArg0 = { "portName", iocshArgString };
+  static const iocshArg setCoalescingArg1 = { "enable",   iocshArgInt };
+  static const iocshArg * const setCoalescingArgs[] = { &setCoalescingArg0, &setCoalescingArg1 };
+  static const iocshFuncDef setCoalescingFuncDef = { "drvAsynIsegVdsSetCoalescing", 2, setCoalescingArgs };
+  static void setCoalescingCallFunc( const iocshArgBuf *args ) {
+    drvAsynIsegVdsSetCoalescing( args[0].sval, args[1].ival );
+  }
+
+  //----------------------------------------------------------------------------
+  //! @brief   EPICS iocsh callable function to read all channels of a module
+  //!          with the link locked once and with one time stamp
+  //!
+  //! A16 has no block transfer, snapshots need a VME master mapping the
+  //! A16 space (SIS3100Configure with mapped=1).
+  //!
+  //! @param  [in]  portName   The name of the asyn port driver
+  //! @param  [in]  enable     1: snapshots, 0: channel by channel
+  //! @param  [in]  timeEvent  Event number of the time source (0: system time)
+  //----------------------------------------------------------------------------
+  int drvAsynIsegVdsSetSnapshotMode( const char *portName, const int enable, const int timeEvent ) {
+    drvAsynIsegVds *pDrv = findDriver( portName, "drvAsynIsegVdsSetSnapshotMode" );
+    if( !pDrv ) return( asynError );
+    if( enable && !pDrv->windowsMapped() ) {
+      fprintf( stderr, "drvAsynIsegVdsSetSnapshotMode: VME master of %s does not map the A16 space\n", portName );
+      return( asynError );
+    }
+    if( asynSuccess != pDrv->setSnapshotMode( enable != 0, timeEvent ) ) {
+      fprintf( stderr, "drvAsynIsegVdsSetSnapshotMode: No poller on %s\n", portName );
+      return( asynError );
+    }
+    return( asynSuccess );
+  }
+  static const iocshArg setSnapshotModeArg0 = { "portName",  iocshArgString };
+  static const iocshArg setSnapshotModeArg1 = { "enable",    iocshArgInt };
+  static const iocshArg setSnapshotModeArg2 = { "timeEvent", iocshArgInt };
+  static const iocshArg * const setSnapshotModeArgs[] = { &setSnapshotModeArg0, &setSnapshotModeArg1,
+                                                          &setSnapshotModeArg2 };
+  static const iocshFuncDef setSnapshotModeFuncDef = { "drvAsynIsegVdsSetSnapshotMode", 3, setSnapshotModeArgs };
+  static void setSnapshotModeCallFunc( const iocshArgBuf *args ) {
+    drvAsynIsegVdsSetSnapshotMode( args[0].sval, args[1].ival, args[2].ival );
+  }
+
+  //----------------------------------------------------------------------------
+  //! @brief   EPICS iocsh callable function to keep a history of the
+  //!          measured values of all channels
+  //!
+  //! A current trip freezes the history of the channel, writing 0 to
+  //! HistoryFrozen rearms it.
+  //!
+  //! @param  [in]  portName  The name of the asyn port driver
+  //! @param  [in]  samples   Number of samples per channel (0: disabled)
+  //! @param  [in]  period    Interval of publishing the history in seconds
+  //----------------------------------------------------------------------------
+  int drvAsynIsegVdsSetHistory( const char *portName, const int samples, const double period ) {
+    drvAsynIsegVds *pDrv = findDriver( portName, "drvAsynIsegVdsSetHistory" );
+    if( !pDrv ) return( asynError );
+    if( samples < 0 || asynSuccess != pDrv->setHistory( samples, period ) ) {
+      fprintf( stderr, "drvAsynIsegVdsSetHistory: Invalid arguments or no poller on %s\n", portName );
+      return( asynError );
+    }
+    return( asynSuccess );
+  }
+  static const iocshArg setHistoryArg0 = { "portName", iocshArgString };
+  static const iocshArg setHistoryArg1 = { "samples",  iocshArgInt };
+  static const iocshArg setHistoryArg2 = { "period",   iocshArgDouble };
+  static const iocshArg * const setHistoryArgs[] = { &setHistoryArg0, &setHistoryArg1, &setHistoryArg2 };
+  static const iocshFuncDef setHistoryFuncDef = { "drvAsynIsegVdsSetHistory", 3, setHistoryArgs };
+  static void setHistoryCallFunc( const iocshArgBuf *args ) {
+    drvAsynIsegVdsSetHistory( args[0].sval, args[1].ival, args[2].dval );
+  }
+
+  //----------------------------------------------------------------------------
+  //! @brief   EPICS iocsh callable function to keep the register images of
+  //!          all modules in a file
+  //!
+  //! The file is loaded at iocInit before the first bus read and written
+  //! periodically and on exit.
+  //!
+  //! @param  [in]  portName  The name of the asyn port driver
+  //! @param  [in]  fileName  Name of the register image file
+  //! @param  [in]  period    Interval of saving in seconds (0: on exit only)
+  //----------------------------------------------------------------------------
+  int drvAsynIsegVdsSetImageFile( const char *portName, const char *fileName, const double period ) {
+    drvAsynIsegVds *pDrv = findDriver( portName, "drvAsynIsegVdsSetImageFile" );
+    if( !pDrv ) return( asynError );
+    if( asynSuccess != pDrv->setImageFile( fileName, period ) ) {
+      fprintf( stderr, "drvAsynIsegVdsSetImageFile: Invalid arguments or file already set on %s\n", portName );
+      return( asynError );
+    }
+    return( asynSuccess );
+  }
+  static const iocshArg setImageFileArg0 = { "portName", iocshArgString };
+  static const iocshArg setImageFileArg1 = { "fileName", iocshArgString };
+  static const iocshArg setImageFileArg2 = { "period",   iocshArgDouble };
+  static const iocshArg * const setImageFileArgs[] = { &setImageFileArg0, &setImageFileArg1, &setImageFileArg2 };
+  static const iocshFuncDef setImageFileFuncDef = { "drvAsynIsegVdsSetImageFile", 3, setImageFileArgs };
+  static void setImageFileCallFunc( const iocshArgBuf *args ) {
+    drvAsynIsegVdsSetImageFile( args[0].sval, args[1].sval, args[2].dval );
+  }
+
+  //----------------------------------------------------------------------------
+  //! @brief   EPICS iocsh callable function to start the event handler
+  //!
+  //! On an event only the status and event status of the flagged channels
+  //! are read and published.
+  //!
+  //! @param  [in]  portName  The name of the asyn port driver
+  //! @param  [in]  period    Interval of the event status poll in seconds
+  //! @param  [in]  irqLevel  VME interrupt level of the modules (0: poll event status)
+  //----------------------------------------------------------------------------
+  int drvAsynIsegVdsSetEventMode( const char *portName, const double period, const int irqLevel ) {
+    drvAsynIsegVds *pDrv = findDriver( portName, "drvAsynIsegVdsSetEventMode" );
+    if( !pDrv ) return( asynError );
+    if( asynSuccess != pDrv->startEventHandler( period, irqLevel ) ) {
+      fprintf( stderr, "drvAsynIsegVdsSetEventMode: Could not start event handler of %s\n", portName );
+      return( asynError );
+    }
+    return( asynSuccess );
+  }
+  static const iocshArg setEventModeArg0 = { "portName", iocshArgString };
+  static const iocshArg setEventModeArg1 = { "period",   iocshArgDouble };
+  static const iocshArg setEventModeArg2 = { "irqLevel", iocshArgInt };
+  static const iocshArg * const setEventModeArgs[] = { &setEventModeArg0, &setEventModeArg1, &setEventModeArg2 };
+  static const iocshFuncDef setEventModeFuncDef = { "drvAsynIsegVdsSetEventMode", 3, setEventModeArgs };
+  static void setEventModeCallFunc( const iocshArgBuf *args ) {
+    drvAsynIsegVdsSetEventMode( args[0].sval, args[1].dval, args[2].ival );
+  }
+
+  //----------------------------------------------------------------------------
+  //! @brief   EPICS iocsh callable function to set the rates of the poller
+  //!
+  //! @param  [in]  portName    The name of the asyn port driver
+  //! @param  [in]  fastPeriod  Interval in seconds for ramping channels and channels with events
+  //! @param  [in]  slowPeriod  Interval in seconds for all registers
+  //----------------------------------------------------------------------------
+  int drvAsynIsegVdsSetPollRates( const char *portName, const double fastPeriod, const double slowPeriod ) {
+    drvAsynIsegVds *pDrv = findDriver( portName, "drvAsynIsegVdsSetPollRates" );
+    if( !pDrv ) return( asynError );
+    if( asynSuccess != pDrv->setPollRates( fastPeriod, slowPeriod ) ) {
+      fprintf( stderr, "drvAsynIsegVdsSetPollRates: Invalid periods or no poller on %s\n", portName );
+      return( asynError );
+    }
+    return( asynSuccess );
+  }
+  static const iocshArg setPollRatesArg0 = { "portName",   iocshArgString };
+  static const iocshArg setPollRatesArg1 = { "fastPeriod", iocshArgDouble };
+  static const iocshArg setPollRatesArg2 = { "slowPeriod", iocshArgDouble };
+  static const iocshArg * const setPollRatesArgs[] = { &setPollRatesArg0, &setPollRatesArg1, &setPollRatesArg2 };
+  static const iocshFuncDef setPollRatesFuncDef = { "drvAsynIsegVdsSetPollRates", 3, setPollRatesArgs };
+  static void setPollRatesCallFunc( const iocshArgBuf *args ) {
+    drvAsynIsegVdsSetPollRates( args[0].sval, args[1].dval, args[2].dval );
+  }
+
+  //----------------------------------------------------------------------------
+  //! @brief   EPICS iocsh callable function to print the report of a port
+  //!
+  //! @param  [in]  portName  The name of the asyn port driver
+  //! @param  [in]  level     Level of detail
+  //----------------------------------------------------------------------------
+  int drvAsynIsegVdsReport( const char *portName, const int level ) {
+    drvAsynIsegVds *pDrv = findDriver( portName, "drvAsynIsegVdsReport" );
+    if( !pDrv ) return( asynError );
+    pDrv->report( stdout, level );
+    return( asynSuccess );
+  }
+  static const iocshArg reportArg0 = { "portName", iocshArgString };
+  static const iocshArg reportArg1 = { "level",    iocshArgInt };
+  static const iocshArg * const reportArgs[] = { &reportArg0, &reportArg1 };
+  static const iocshFuncDef reportFuncDef = { "drvAsynIsegVdsReport", 2, reportArgs };
+  static void reportCallFunc( const iocshArgBuf *args ) {
+    drvAsynIsegVdsReport( args[0].sval, args[1].ival );
+  }
+
   //----------------------------------------------------------------------------
   //! @brief   Register functions to EPICS
   //----------------------------------------------------------------------------
@@ -415,6 +3460,17 @@ extern "C" {
     static int firstTime = 1;
     if ( firstTime ) {
       iocshRegister( &initIsegVdsFuncDef, initIsegVdsCallFunc );
+      iocshRegister( &initCrateFuncDef, initCrateCallFunc );
+      iocshRegister( &setDeadbandFuncDef, setDeadbandCallFunc );
+      iocshRegister( &setWriteWindowFuncDef, setWriteWindowCallFunc );
+      iocshRegister( &setCacheAgeFuncDef, setCacheAgeCallFunc );
+      iocshRegister( &setCoalescingFuncDef, setCoalescingCallFunc );
+      iocshRegister( &setSnapshotModeFuncDef, setSnapshotModeCallFunc );
+      iocshRegister( &setHistoryFuncDef, setHistoryCallFunc );
+      iocshRegister( &setImageFileFuncDef, setImageFileCallFunc );
+      iocshRegister( &setEventModeFuncDef, setEventModeCallFunc );
+      iocshRegister( &setPollRatesFuncDef, setPollRatesCallFunc );
+      iocshRegister( &reportFuncDef, reportCallFunc );
       firstTime = 0;
     }
   }
@@ -25,9 +25,19 @@
 #define __ASYN_ISEG_VDS_H__
 
 //_____ I N C L U D E S _______________________________________________________
-#include <map>
+#include <utility>
+#include <vector>
+#include <epicsEvent.h>
+#include <epicsMutex.h>
+#include <epicsThread.h>
+#include <epicsTimer.h>
 #include "asynPortDriver.h"
 
+#include "HistoryBuffer.h"
+#include "LatencyHistogram.h"
+#include "RegisterImage.h"
+#include "VmeMaster.h"
+
 //_____ D E F I N I T I O N S __________________________________________________
 
 // These are the drvInfo strings that are used to identify the parameters.
@@ -58,66 +68,414 @@
 #define P_ISEGVDS_CHANIMOM_STRING          "CurrentMeasure"           //!< asynFloat64,        r  
 #define P_ISEGVDS_CHANVBOUNDS_STRING       "VoltageBounds"            //!< asynFloat64,        r/w
 #define P_ISEGVDS_CHANIBOUNDS_STRING       "CurrentBounds"            //!< asynFloat64,        r/w
+#define P_ISEGVDS_VSETALL_STRING           "VoltageSetAll"            //!< asynFloat64Array,   r/w
+#define P_ISEGVDS_VMOMALL_STRING           "VoltageMeasureAll"        //!< asynFloat64Array,   r  
+#define P_ISEGVDS_IMOMALL_STRING           "CurrentMeasureAll"        //!< asynFloat64Array,   r  
+#define P_ISEGVDS_CHANSTATUSALL_STRING     "ChannelStatusAll"         //!< asynInt32Array,     r  
+#define P_ISEGVDS_VMOMHISTORY_STRING       "VoltageMeasureHistory"    //!< asynFloat64Array,   r  
+#define P_ISEGVDS_IMOMHISTORY_STRING       "CurrentMeasureHistory"    //!< asynFloat64Array,   r  
+#define P_ISEGVDS_HISTORYFROZEN_STRING     "HistoryFrozen"            //!< asynInt32,          r/w
+#define P_ISEGVDS_RAMPTARGET_STRING        "RampTarget"               //!< asynFloat64,        r/w
+#define P_ISEGVDS_RAMPSPEED_STRING         "RampSpeed"                //!< asynFloat64,        r/w
+#define P_ISEGVDS_RAMPMAXDIFF_STRING       "RampMaxDiff"              //!< asynFloat64,        r/w
+#define P_ISEGVDS_RAMPRUN_STRING           "RampRun"                  //!< asynInt32,          r/w
+#define P_ISEGVDS_MODCHANSTATUSOR_STRING   "ModuleChannelStatusOr"    //!< asynUInt32Digital,  r  
+#define P_ISEGVDS_MODCHANSTATUSAND_STRING  "ModuleChannelStatusAnd"   //!< asynUInt32Digital,  r  
+#define P_ISEGVDS_MODVMOMMIN_STRING        "ModuleVoltageMeasureMin"  //!< asynFloat64,        r  
+#define P_ISEGVDS_MODVMOMMAX_STRING        "ModuleVoltageMeasureMax"  //!< asynFloat64,        r  
+#define P_ISEGVDS_MODVMOMMEAN_STRING       "ModuleVoltageMeasureMean" //!< asynFloat64,        r  
+#define P_ISEGVDS_MODVMOMSUM_STRING        "ModuleVoltageMeasureSum"  //!< asynFloat64,        r  
+#define P_ISEGVDS_MODIMOMMIN_STRING        "ModuleCurrentMeasureMin"  //!< asynFloat64,        r  
+#define P_ISEGVDS_MODIMOMMAX_STRING        "ModuleCurrentMeasureMax"  //!< asynFloat64,        r  
+#define P_ISEGVDS_MODIMOMMEAN_STRING       "ModuleCurrentMeasureMean" //!< asynFloat64,        r  
+#define P_ISEGVDS_MODIMOMSUM_STRING        "ModuleCurrentMeasureSum"  //!< asynFloat64,        r  
+#define P_ISEGVDS_MODCHANSON_STRING        "ModuleChannelsOn"         //!< asynInt32,          r  
+#define P_ISEGVDS_MODCHANSRAMPING_STRING   "ModuleChannelsRamping"    //!< asynInt32,          r  
+#define P_ISEGVDS_PORTCHANSTATUSOR_STRING  "PortChannelStatusOr"      //!< asynUInt32Digital,  r  
+#define P_ISEGVDS_PORTCHANSTATUSAND_STRING "PortChannelStatusAnd"     //!< asynUInt32Digital,  r  
+#define P_ISEGVDS_PORTVMOMMIN_STRING       "PortVoltageMeasureMin"    //!< asynFloat64,        r  
+#define P_ISEGVDS_PORTVMOMMAX_STRING       "PortVoltageMeasureMax"    //!< asynFloat64,        r  
+#define P_ISEGVDS_PORTVMOMMEAN_STRING      "PortVoltageMeasureMean"   //!< asynFloat64,        r  
+#define P_ISEGVDS_PORTVMOMSUM_STRING       "PortVoltageMeasureSum"    //!< asynFloat64,        r  
+#define P_ISEGVDS_PORTIMOMMIN_STRING       "PortCurrentMeasureMin"    //!< asynFloat64,        r  
+#define P_ISEGVDS_PORTIMOMMAX_STRING       "PortCurrentMeasureMax"    //!< asynFloat64,        r  
+#define P_ISEGVDS_PORTIMOMMEAN_STRING      "PortCurrentMeasureMean"   //!< asynFloat64,        r  
+#define P_ISEGVDS_PORTIMOMSUM_STRING       "PortCurrentMeasureSum"    //!< asynFloat64,        r  
+#define P_ISEGVDS_PORTCHANSON_STRING       "PortChannelsOn"           //!< asynInt32,          r  
+#define P_ISEGVDS_PORTCHANSRAMPING_STRING  "PortChannelsRamping"      //!< asynInt32,          r  
+#define P_ISEGVDS_STATCOUNT_STRING         "StatCount"                //!< asynInt32,          r  
+#define P_ISEGVDS_STATERRORS_STRING        "StatErrors"               //!< asynInt32,          r  
+#define P_ISEGVDS_STATMIN_STRING           "StatMin"                  //!< asynFloat64,        r  
+#define P_ISEGVDS_STATAVG_STRING           "StatAvg"                  //!< asynFloat64,        r  
+#define P_ISEGVDS_STATP99_STRING           "StatP99"                  //!< asynFloat64,        r  
+#define P_ISEGVDS_STATMAX_STRING           "StatMax"                  //!< asynFloat64,        r  
+#define P_ISEGVDS_LINKCYCLES_STRING        "LinkCycles"               //!< asynInt32,          r  
+#define P_ISEGVDS_LINKERRORS_STRING        "LinkErrors"               //!< asynInt32,          r  
+#define P_ISEGVDS_LINKCONTENTIONS_STRING   "LinkContentions"          //!< asynInt32,          r  
+
+#define ISEGVDS_NCHANNELS  8  //!< number of channels of one VDS module
+
+//! Scope of a VDS register
+enum {
+  ISEGVDS_MODULE  = 0,  //!< register relative to module base address
+  ISEGVDS_CHANNEL = 1   //!< register relative to channel base address
+};
+
+//! Access mode flags of a VDS register
+enum {
+  ISEGVDS_READ   = 0x1,  //!< register can be read
+  ISEGVDS_WRITE  = 0x2,  //!< register can be written
+  ISEGVDS_CACHED = 0x4,  //!< register only changes by writes of the driver
+  ISEGVDS_STATIC = 0x8   //!< register never changes, it is read once
+};
+
+//! Operation classes of the latency statistics, the Stat* parameters of a
+//! class are at the asyn address 8 * number of modules + class
+enum {
+  ISEGVDS_STAT_READ  = 0,  //!< single register reads of asyn clients
+  ISEGVDS_STAT_WRITE = 1,  //!< single register writes of asyn clients
+  ISEGVDS_STAT_ARRAY = 2,  //!< array reads and writes of asyn clients
+  ISEGVDS_STAT_POLL  = 3,  //!< poll of one module by the poller
+  ISEGVDS_STAT_EVENT = 4,  //!< event check of one module
+  ISEGVDS_STAT_LOCK  = 5,  //!< wait for the port in the priority lanes
+  ISEGVDS_NUM_STATS  = 6
+};
+
+//! Priority lanes of the port lock, a lane waits while lanes with a lower
+//! number wait for the port
+enum {
+  ISEGVDS_LANE_WRITE      = 0,  //!< register writes of asyn clients (setpoints, ChannelControl)
+  ISEGVDS_LANE_EVENT      = 1,  //!< event and status refresh by the event handler
+  ISEGVDS_LANE_CLIENT     = 2,  //!< other requests of asyn clients and the flush of coalesced writes
+  ISEGVDS_LANE_POLL       = 3,  //!< polling of all registers and the ramp engine
+  ISEGVDS_LANE_BACKGROUND = 4,  //!< publishing of history and statistics
+  ISEGVDS_NUM_LANES       = 5
+};
+
+//! Status bits used by the poller
+enum {
+  ISEGVDS_MODSTATUS_RAMPING  = 0x0200,  //!< ModuleStatus B9: channels ramping
+  ISEGVDS_CHANSTATUS_ON      = 0x0008,  //!< ChannelStatus B3: channel on
+  ISEGVDS_CHANSTATUS_RAMPING = 0x0010,  //!< ChannelStatus B4: channel ramping
+  ISEGVDS_CHANSTATUS_EMCY    = 0x0020,  //!< ChannelStatus B5: emergency off
+  ISEGVDS_CHANSTATUS_CBOUNDS = 0x0400,  //!< ChannelStatus B10: current out of bounds
+  ISEGVDS_CHANSTATUS_VBOUNDS = 0x0800,  //!< ChannelStatus B11: voltage out of bounds
+  ISEGVDS_CHANSTATUS_INHIBIT = 0x1000,  //!< ChannelStatus B12: external inhibit
+  ISEGVDS_CHANSTATUS_TRIP    = 0x2000   //!< ChannelStatus B13: current trip
+};
+
+//! @brief   Description of a register of the VDS module
+//!
+//! One entry per register, the position in the table is the index of
+//! the corresponding parameter in the parameter library.
+typedef struct {
+  const char    *name;    //!< drvInfo string of the parameter
+  asynParamType  type;    //!< asynParamUInt32Digital (bit field) or asynParamFloat64 (float32)
+  int            scope;   //!< ISEGVDS_MODULE or ISEGVDS_CHANNEL
+  int            access;  //!< combination of ISEGVDS_READ, ISEGVDS_WRITE, ISEGVDS_CACHED and ISEGVDS_STATIC
+  epicsUInt32    offset;  //!< address relative to module or channel base address
+  epicsFloat64   scale;   //!< factor from register value to engineering unit
+} isegVdsRegister;
 
-// Forward declaration
-class VmeMaster;
+//! @brief   Description of a parameter without register of its own
+typedef struct {
+  const char    *name;    //!< drvInfo string of the parameter
+  asynParamType  type;    //!< type of the parameter
+} isegVdsParameter;
+
+//! @brief   Aggregate of the channels of a module or of all modules of a port
+typedef struct {
+  int            channels;   //!< number of channels aggregated
+  epicsUInt32    statusOr;   //!< ChannelStatus bits set in any channel
+  epicsUInt32    statusAnd;  //!< ChannelStatus bits set in all channels
+  epicsFloat64   vmomMin;    //!< min. magnitude of VoltageMeasure
+  epicsFloat64   vmomMax;    //!< max. magnitude of VoltageMeasure
+  epicsFloat64   vmomSum;    //!< sum of VoltageMeasure
+  epicsFloat64   imomMin;    //!< min. magnitude of CurrentMeasure
+  epicsFloat64   imomMax;    //!< max. magnitude of CurrentMeasure
+  epicsFloat64   imomSum;    //!< sum of CurrentMeasure
+  int            on;         //!< number of channels switched on
+  int            ramping;    //!< number of channels ramping
+} isegVdsAggregate;
 
 //! @brief   asynPortDriver for ISEG VDS high voltage modules
 //!
 //! This asynPortDriver is used as device support for the
 //! VDS high voltage modules of ISEG Spezialelektronik GmbH.
+//! One port serves one or more modules of a crate: the asyn address of
+//! channel ch of module m is m * ISEGVDS_NCHANNELS + ch, the module
+//! registers of module m are published at address m * ISEGVDS_NCHANNELS.
 class drvAsynIsegVds : public asynPortDriver {
  public:
-  drvAsynIsegVds( const char *portName, const int BA );
+  drvAsynIsegVds( const char *portName, const std::vector<epicsUInt32>& baseAddresses,
+                  const double pollPeriod, const char *link );
 
   // These are the methods that we override from asynPortDriver
   virtual asynStatus readUInt32Digital( asynUser *pasynUser, epicsUInt32 *value, epicsUInt32 mask );
   virtual asynStatus writeUInt32Digital( asynUser *pasynUser, epicsUInt32 value, epicsUInt32 mask );
   virtual asynStatus writeFloat64( asynUser *pasynUser, epicsFloat64 value );
   virtual asynStatus readFloat64( asynUser *pasynUser, epicsFloat64 *value );
+  virtual asynStatus readFloat64Array( asynUser *pasynUser, epicsFloat64 *value, size_t nElements, size_t *nIn );
+  virtual asynStatus writeFloat64Array( asynUser *pasynUser, epicsFloat64 *value, size_t nElements );
+  virtual asynStatus readInt32Array( asynUser *pasynUser, epicsInt32 *value, size_t nElements, size_t *nIn );
+  virtual asynStatus readInt32( asynUser *pasynUser, epicsInt32 *value );
+  virtual asynStatus writeInt32( asynUser *pasynUser, epicsInt32 value );
+  virtual asynStatus connect( asynUser *pasynUser );
+  virtual asynStatus getAddress( asynUser *pasynUser, int *address );
+  virtual asynStatus lock();
+  virtual asynStatus unlock();
+  virtual void report( FILE *fp, int details );
+
+  asynStatus laneWrite( asynUser *pasynUser, epicsFloat64 value );
+  asynStatus laneWrite( asynUser *pasynUser, epicsUInt32 value, epicsUInt32 mask );
+  asynStatus laneWrite( asynUser *pasynUser, epicsFloat64 *value, size_t nElements );
+
+  bool isConfigured() const { return _configured; }
+  bool windowsMapped() const { return _windowsMapped; }
+  void pollerThread();
+  void eventThread();
+  asynStatus startEventHandler( double period, int irqLevel );
+  asynStatus setPollRates( double fastPeriod, double slowPeriod );
+  asynStatus setDeadband( const char *paramName, double deadband );
+  asynStatus setWriteWindow( const char *paramName, double window );
+  void flushWrites();
+  void setCacheMaxAge( double maxAge );
+  asynStatus setCoalescing( bool enable );
+  asynStatus setSnapshotMode( bool enable, int timeEvent );
+  asynStatus setHistory( size_t samples, double period );
+  asynStatus setImageFile( const char *path, double period );
+  void saveImage();
+  void seedParameters();
+  void endInitPhase();
 
  protected:
   // Values used for pasynUser->reason, and indexes into the parameter library.
-  int P_ModStatus;         //!< index of Parameter "ModuleStatus"
-  int P_ModEvtStatus;      //!< index of Parameter "ModuleEventStatus"
-  int P_ModEvtMask;        //!< index of Parameter "ModuleEventMask"
-  int P_ModCtrl;           //!< index of Parameter "ModuleControl"
-  int P_ModEvtChanStatus;  //!< index of Parameter "ModuleEventChannelStatus"
-  int P_ModEvtChanMask;    //!< index of Parameter "ModuleEventChannelMask"
-  int P_ModEvtGrpStatus;   //!< index of Parameter "ModuleEventGroupStatus"
-  int P_ModEvtGrpMask;     //!< index of Parameter "ModuleEventGroupMask"
-  int P_VRamp;             //!< index of Parameter "VoltageRampSpeed"
-  int P_CRamp;             //!< index of Parameter "CurrentRampSpeed"
-  int P_VMax;              //!< index of Parameter "VoltageMax"
-  int P_IMax;              //!< index of Parameter "CurrentMax"
-  int P_SupplyP5;          //!< index of Parameter "SupplyP5"
-  int P_SupplyP12;         //!< index of Parameter "SupplyP12"
-  int P_SupplyN12;         //!< index of Parameter "SupplyN12"
-  int P_Temperature;       //!< index of Parameter "Temperature"
-  int P_ChanStatus;        //!< index of Parameter "ChannelStatus"
-  int P_ChanEvtStatus;     //!< index of Parameter "ChannelEventStatus"
-  int P_ChanEvtMask;       //!< index of Parameter "ChannelEventMask"
-  int P_ChanCtrl;          //!< index of Parameter "ChannelControl"
-  int P_ChanVset;          //!< index of Parameter "VoltageSet"
-  int P_ChanIset;          //!< index of Parameter "CurrentSet"
-  int P_ChanVmom;          //!< index of Parameter "VoltageMeasure"
-  int P_ChanImom;          //!< index of Parameter "CurrentMeasure"
-  int P_ChanVBounds;       //!< index of Parameter "VoltageBounds"
-  int P_ChanIBounds;       //!< index of Parameter "CurrentBounds"
-
-#define FIRST_ISEGVDS_COMMAND P_ModStatus
-#define LAST_ISEGVDS_COMMAND  P_ChanImom
+  // The order has to match the register descriptor table isegVdsRegisters.
+  enum {
+    P_ModStatus,         //!< index of Parameter "ModuleStatus"
+    P_ModEvtStatus,      //!< index of Parameter "ModuleEventStatus"
+    P_ModEvtMask,        //!< index of Parameter "ModuleEventMask"
+    P_ModCtrl,           //!< index of Parameter "ModuleControl"
+    P_ModEvtChanStatus,  //!< index of Parameter "ModuleEventChannelStatus"
+    P_ModEvtChanMask,    //!< index of Parameter "ModuleEventChannelMask"
+    P_ModEvtGrpStatus,   //!< index of Parameter "ModuleEventGroupStatus"
+    P_ModEvtGrpMask,     //!< index of Parameter "ModuleEventGroupMask"
+    P_VRamp,             //!< index of Parameter "VoltageRampSpeed"
+    P_CRamp,             //!< index of Parameter "CurrentRampSpeed"
+    P_VMax,              //!< index of Parameter "VoltageMax"
+    P_IMax,              //!< index of Parameter "CurrentMax"
+    P_SupplyP5,          //!< index of Parameter "SupplyP5"
+    P_SupplyP12,         //!< index of Parameter "SupplyP12"
+    P_SupplyN12,         //!< index of Parameter "SupplyN12"
+    P_Temperature,       //!< index of Parameter "Temperature"
+    P_ChanStatus,        //!< index of Parameter "ChannelStatus"
+    P_ChanEvtStatus,     //!< index of Parameter "ChannelEventStatus"
+    P_ChanEvtMask,       //!< index of Parameter "ChannelEventMask"
+    P_ChanCtrl,          //!< index of Parameter "ChannelControl"
+    P_ChanVset,          //!< index of Parameter "VoltageSet"
+    P_ChanIset,          //!< index of Parameter "CurrentSet"
+    P_ChanVmom,          //!< index of Parameter "VoltageMeasure"
+    P_ChanImom,          //!< index of Parameter "CurrentMeasure"
+    P_ChanVBounds,       //!< index of Parameter "VoltageBounds"
+    P_ChanIBounds,       //!< index of Parameter "CurrentBounds"
+    NUM_ISEGVDS_REGISTERS,
+    // array parameters with one element per channel, served at the module address
+    P_VSetAll = NUM_ISEGVDS_REGISTERS, //!< index of Parameter "VoltageSetAll"
+    P_VMomAll,           //!< index of Parameter "VoltageMeasureAll"
+    P_IMomAll,           //!< index of Parameter "CurrentMeasureAll"
+    P_ChanStatusAll,     //!< index of Parameter "ChannelStatusAll"
+    // history of measured values, served at the channel address
+    P_VMomHistory,       //!< index of Parameter "VoltageMeasureHistory"
+    P_IMomHistory,       //!< index of Parameter "CurrentMeasureHistory"
+    P_HistoryFrozen,     //!< index of Parameter "HistoryFrozen"
+    // ramp engine, RampTarget at the channel address, the others at address 0
+    P_RampTarget,        //!< index of Parameter "RampTarget"
+    P_RampSpeed,         //!< index of Parameter "RampSpeed"
+    P_RampMaxDiff,       //!< index of Parameter "RampMaxDiff"
+    P_RampRun,           //!< index of Parameter "RampRun"
+    // aggregates of the channels of a module, served at the module address
+    P_ModStatusOr,       //!< index of Parameter "ModuleChannelStatusOr"
+    P_ModStatusAnd,      //!< index of Parameter "ModuleChannelStatusAnd"
+    P_ModVmomMin,        //!< index of Parameter "ModuleVoltageMeasureMin"
+    P_ModVmomMax,        //!< index of Parameter "ModuleVoltageMeasureMax"
+    P_ModVmomMean,       //!< index of Parameter "ModuleVoltageMeasureMean"
+    P_ModVmomSum,        //!< index of Parameter "ModuleVoltageMeasureSum"
+    P_ModImomMin,        //!< index of Parameter "ModuleCurrentMeasureMin"
+    P_ModImomMax,        //!< index of Parameter "ModuleCurrentMeasureMax"
+    P_ModImomMean,       //!< index of Parameter "ModuleCurrentMeasureMean"
+    P_ModImomSum,        //!< index of Parameter "ModuleCurrentMeasureSum"
+    P_ModChansOn,        //!< index of Parameter "ModuleChannelsOn"
+    P_ModChansRamping,   //!< index of Parameter "ModuleChannelsRamping"
+    // aggregates of the channels of all modules, served at address 0
+    P_PortStatusOr,      //!< index of Parameter "PortChannelStatusOr"
+    P_PortStatusAnd,     //!< index of Parameter "PortChannelStatusAnd"
+    P_PortVmomMin,       //!< index of Parameter "PortVoltageMeasureMin"
+    P_PortVmomMax,       //!< index of Parameter "PortVoltageMeasureMax"
+    P_PortVmomMean,      //!< index of Parameter "PortVoltageMeasureMean"
+    P_PortVmomSum,       //!< index of Parameter "PortVoltageMeasureSum"
+    P_PortImomMin,       //!< index of Parameter "PortCurrentMeasureMin"
+    P_PortImomMax,       //!< index of Parameter "PortCurrentMeasureMax"
+    P_PortImomMean,      //!< index of Parameter "PortCurrentMeasureMean"
+    P_PortImomSum,       //!< index of Parameter "PortCurrentMeasureSum"
+    P_PortChansOn,       //!< index of Parameter "PortChannelsOn"
+    P_PortChansRamping,  //!< index of Parameter "PortChannelsRamping"
+    // statistics, the asyn address selects the operation class
+    P_StatCount,         //!< index of Parameter "StatCount"
+    P_StatErrors,        //!< index of Parameter "StatErrors"
+    P_StatMin,           //!< index of Parameter "StatMin"
+    P_StatAvg,           //!< index of Parameter "StatAvg"
+    P_StatP99,           //!< index of Parameter "StatP99"
+    P_StatMax,           //!< index of Parameter "StatMax"
+    P_LinkCycles,        //!< index of Parameter "LinkCycles"
+    P_LinkErrors,        //!< index of Parameter "LinkErrors"
+    P_LinkContentions,   //!< index of Parameter "LinkContentions"
+    NUM_ISEGVDS_PARAMETERS
+  };
 
  private:
-  std::map<int, epicsUInt32> _chancmds;
-  std::map<int, epicsUInt32> _modcmds;
+  VmeMaster::Status readBlock( size_t module, epicsUInt32 subAddress, epicsUInt32 nwords, epicsUInt32* buffer );
+  VmeMaster::Status readChannelBlocks( size_t module, epicsUInt32* chanData, epicsTimeStamp& snapshot );
+  bool fromSnapshot( int addr, int function, epicsTimeStamp& snapshot ) const;
+  VmeMaster::Status writeRegister( int addr, epicsUInt32 vmeAddr, epicsUInt32 value, bool verify, epicsUInt32& readback );
+  int arrayElement( int function ) const;
+  VmeMaster::Status readChannels( int addr, int function, epicsUInt32* vmeData );
+  void doArrayCallbacks( int addr, const epicsUInt32* chanData, const epicsFloat64* chanValues );
+  bool preempted( int lane ) const;
+  bool isRegisterWrite( int function ) const;
+  void interposeWrites();
+  void lockLane( int lane );
+  void yieldLane( int lane );
+  void publishStatistics();
+  void queueWrite( int addr, int function, epicsUInt32 vmeData );
+  void storeWord( int addr, int function, epicsUInt32 vmeData, std::vector<epicsUInt32>& image );
+  void beginCycle( const epicsTimeStamp& snapshot );
+  void markDirty( int addr );
+  void endCycle();
+  void publishWrite( int addr, const epicsTimeStamp& when );
+  VmeMaster::Status handleEvents( size_t module, bool acknowledge );
+  VmeMaster::Status pollModule( size_t module, epicsUInt32* modData, epicsUInt32* chanData );
+  VmeMaster::Status pollActive( size_t module, epicsUInt32* modData, epicsUInt32* chanData );
+  VmeMaster::Status probeModule( size_t module, epicsUInt32* modData, epicsUInt32* chanData );
+  void forgetModule( size_t module );
+  void setLinkConnected( bool connected );
+  void setModuleConnected( size_t module, bool connected );
+  bool retryDue( size_t index ) const;
+  void backoffRetry( size_t index );
+  void updateActivity( int addr, const epicsUInt32* chanData );
+  void recordHistory( int addr, const epicsUInt32* chanData, const epicsFloat64* chanValues );
+  void publishHistory();
+  void aggregateModule( size_t module, const epicsUInt32* chanData, const epicsFloat64* chanValues );
+  void publishAggregate( int addr, int first, const isegVdsAggregate& aggregate );
+  void publishPortAggregate();
+  void loadImage( RegisterImage& image );
+  unsigned compareImage( const RegisterImage& image, size_t module, const epicsUInt32* modData,
+                         const epicsUInt32* chanData ) const;
+  void startRamp( bool run );
+  void runRamp();
+  void updateParam( int addr, int function, epicsUInt32 vmeData );
+  void updateParam( int addr, int function, epicsUInt32 vmeData, epicsFloat64 value, bool cold = false );
+  asynStatus setBits( int addr, int function, epicsUInt32 value, epicsUInt32 mask, bool all = false );
+  void convertBlocks( int scope, const epicsUInt32* raw, size_t blocks, epicsFloat64* values ) const;
+  bool insideBounds( int function, const epicsUInt32* vmeData, epicsUInt32 lastStatus ) const;
+  void updateBlock( int addr, int scope, const epicsUInt32* vmeData, const epicsFloat64* values,
+                    std::vector<epicsUInt32>& image );
+  epicsFloat64 toDouble( int function, epicsUInt32 vmeData ) const;
+  bool isCacheValid( int addr, int function ) const;
+  void confirmCache( int addr, int function, const epicsTimeStamp& when );
+  void confirmCache( int addr, int function );
+
+  std::vector<int>     _blockParams[2];  //!< parameters of module and channel register blocks
+  epicsUInt32          _blockWords[2];   //!< size of module and channel register blocks
+  std::vector<epicsFloat64> _blockScale[2];  //!< scale of each word of a block, 0 for bit fields
+  std::vector<epicsFloat64> _modValues;      //!< converted module block of the running poll
+  std::vector<epicsFloat64> _chanValues;     //!< converted channel blocks of the running poll
 
   char                *_deviceName;
-  epicsUInt32          _base;
+  std::vector<epicsUInt32> _bases;  //!< VME base addresses, indexed by module number
+  int                  _chanAddrs;  //!< number of channel addresses, the statistics follow them
   VmeMaster           *_vme;
 
+  double               _pollPeriod;  //!< interval of background poller in seconds (0: disabled)
+  double               _slowPeriod;  //!< interval of full polls of a module in seconds
+  std::vector<epicsTimeStamp> _nextFullPoll;  //!< time of next full poll, indexed by module
+  std::vector<bool>    _chanActive;  //!< channel is ramping or has events, indexed by asyn address
+  bool                 _linkDown;    //!< poller found the VME link down
+  bool                 _configured;  //!< constructor completed, the port is usable
+  std::vector<bool>    _moduleUp;    //!< module answered the last poll, indexed by module
+  std::vector<double>  _retryDelay;  //!< reconnect backoff in seconds, indexed by module, last entry: link
+  std::vector<epicsTimeStamp> _nextRetry;  //!< time of next reconnect probe, same index as _retryDelay
+  asynUser            *_portUser;    //!< connected to the port, signals the link state
+  std::vector<asynUser*> _devUsers;  //!< connected to each asyn address, signal the module state
+  epicsEventId         _pollEvent;
+  epicsThreadId        _pollThread;
+
+  double               _eventPeriod;  //!< interval of event status poll or max. wait for a VME IRQ
+  int                  _irqLevel;     //!< VME interrupt level of the modules (0: poll event status)
+  epicsThreadId        _eventThread;
+
+  std::vector<double>  _deadbands;  //!< deadbands of float parameters used by the poller (0: none)
+  std::vector<double>  _writeWindows;  //!< write coalescing windows of float parameters in seconds (0: none)
+  epicsTimerId         _writeTimer;    //!< ends the coalescing window (0: no window set yet)
+  epicsTimeStamp       _writeDue;      //!< time the write timer is started for
+  std::vector< std::pair<int, int> > _pendingWrites;  //!< asyn address and parameter of held back writes
+  std::vector<epicsUInt32> _pendingValue;  //!< held back register content, indexed by addr * NUM_ISEGVDS_REGISTERS + parameter
+  std::vector<bool>    _writePending;      //!< write is held back, same index as _pendingValue
+  unsigned long        _writesCoalesced;   //!< writes replaced by a later write in the window
+  std::vector< std::vector<epicsUInt32> > _modImage;   //!< shadow of module registers, indexed by module (empty: not filled yet)
+  std::vector< std::vector<epicsUInt32> > _chanImage;  //!< shadow of channel registers, indexed by asyn address
+  std::vector<bool>    _dirty;       //!< parameters updated but not called back yet, indexed by asyn address
+  int                  _cycleDepth;  //!< nesting of open update cycles (0: callbacks flushed)
+  bool                 _coalesceWrites;  //!< callbacks of single writes wait for the next poll cycle
+  bool                 _snapshotMode;  //!< read all channels of a module in one locked transaction list
+  bool                 _windowsMapped; //!< the VME master maps the A16 windows of all modules
+  int                  _timeEvent;     //!< event number of the time source for snapshots (0: system time)
+  std::vector<epicsTimeStamp> _snapshotTime;  //!< time of the last snapshot, indexed by module
+  VmeMaster::TransactionList _snapshotList;   //!< read cycles of the channel blocks of one module
+
+  size_t               _historySize;    //!< samples of the history buffers (0: no history)
+  double               _historyPeriod;  //!< interval of publishing the history in seconds
+  epicsTimeStamp       _nextHistory;    //!< time of next publishing of the history
+  std::vector<HistoryBuffer> _vmomHistory;  //!< history of VoltageMeasure, indexed by asyn address
+  std::vector<HistoryBuffer> _imomHistory;  //!< history of CurrentMeasure, indexed by asyn address
+  std::vector<bool>    _historyCaptured;  //!< frozen history has been published, indexed by asyn address
+  std::vector<bool>    _historyTripped;   //!< trip bit seen by the last recordHistory(), indexed by asyn address
+  std::vector<double>  _historyData;      //!< buffer for publishing one history
+
+  bool                 _rampRunning;   //!< ramp engine is moving channels
+  double               _rampSpeed;     //!< max. setpoint change of the ramp engine in V/s
+  double               _rampMaxDiff;   //!< max. voltage difference between ramped channels (0: none)
+  epicsTimeStamp       _lastRamp;      //!< time of the last ramp step
+  std::vector<double>  _rampTarget;    //!< target voltage, indexed by asyn address
+  std::vector<double>  _rampSet;       //!< last setpoint written by the ramp engine, indexed by asyn address
+  std::vector<bool>    _rampPending;   //!< target set, joins the next ramp, indexed by asyn address
+  std::vector<bool>    _rampActive;    //!< channel is part of the running ramp, indexed by asyn address
+  std::vector<bool>    _rampUp;        //!< channel ramps to a higher magnitude, indexed by asyn address
+
+  char                *_imageFile;    //!< register image file (NULL: none)
+  double               _imagePeriod;  //!< interval of saving the register image in seconds (0: on exit only)
+  epicsTimeStamp       _nextImage;    //!< time of next saving of the register image
+  epicsMutexId         _imageLock;    //!< serialises writers of the register image file
+
+  volatile int         _laneWaiting[ISEGVDS_NUM_LANES];  //!< threads waiting for the port, indexed by lane
+  epicsEventId         _laneEvents[ISEGVDS_NUM_LANES];   //!< wake the waiters of a lane once the lanes above got the port
+  epicsThreadId volatile _lockOwner;  //!< thread holding the port, 0 if none
+  int                  _lockDepth;    //!< nesting depth of the port lock of _lockOwner
+  asynFloat64          _laneFloat64;        //!< asynFloat64 of the port with write classified by lane
+  asynUInt32Digital    _laneUInt32Digital;  //!< asynUInt32Digital of the port with write classified by lane
+  asynFloat64Array     _laneFloat64Array;   //!< asynFloat64Array of the port with write classified by lane
+  asynInterface        _laneInterfaces[3];  //!< interposed interfaces, in the order above
+  asynInterface       *_prevInterfaces[3];  //!< interfaces of asynPortDriver behind them
+
+  std::vector<isegVdsAggregate> _moduleAggregate;  //!< aggregate of the last poll, indexed by module
+
+  LatencyHistogram     _latency[ISEGVDS_NUM_STATS];  //!< latency statistics by operation class
+
+  double               _cacheMaxAge;  //!< max. age of cached setpoints in seconds (0: no caching)
+  bool                 _initPhase;    //!< iocInit still running, reads are served from the seeded parameters
+  std::vector< std::vector<epicsTimeStamp> > _cacheTime; //!< time of last confirmation of cached parameters, indexed by asyn address
+
 };
 
-#define NUM_ISEGVDS_PARAMS (&LAST_ISEGVDS_COMMAND - &FIRST_ISEGVDS_COMMAND + 1)
+#define NUM_ISEGVDS_PARAMS ( drvAsynIsegVds::NUM_ISEGVDS_PARAMETERS )
 
 #endif
@@ -0,0 +1,181 @@
+//******************************************************************************
+// Copyright (C) 2014 Florian Feldbauer <florian@ep1.ruhr-uni-bochum.de>
+//                    - Helmholtz-Institut/University Mainz, Institute for nuclear physics
+//
+// This file is part of drvAsynIsegVds
+//
+// drvAsynIsegVds is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// drvAsynIsegVds is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+//
+// version 1.0.0; Aug. 15, 2014
+//******************************************************************************
+
+//_____ I N C L U D E S _______________________________________________________
+
+// ANSI C/C++ includes
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+// System includes
+#include <sys/resource.h>
+
+// EPICS includes
+#include <epicsThread.h>
+#include <epicsTime.h>
+
+// ASYN includes
+#include <asynDriver.h>
+#include <asynFloat64SyncIO.h>
+
+// local includes
+#include "drvAsynIsegVds.h"
+#include "LatencyHistogram.h"
+
+//_____ D E F I N I T I O N S __________________________________________________
+extern "C" {
+  int vmeMockConfigure( const char *name, const double latency, const double errorRate );
+  int drvAsynIsegVdsCrateConfigure( const char *portName, const char *baseAddresses, const double pollPeriod,
+                                    const char *link );
+}
+
+//_____ L O C A L S ____________________________________________________________
+static const char *benchPort = "bench";
+static const char *benchLink = "benchlink";
+
+//! drvInfo strings cycled through by the simulated records
+static const char *recordParams[] = { P_ISEGVDS_CHANVMOM_STRING, P_ISEGVDS_CHANIMOM_STRING,
+                                      P_ISEGVDS_CHANVSET_STRING, P_ISEGVDS_CHANISET_STRING };
+static const int nRecordParams = sizeof( recordParams ) / sizeof( recordParams[0] );
+
+static const int    recordCounts[] = { 8, 64, 400 };   //!< number of records per sweep
+static const double scanRates[]    = { 1., 10., 100. }; //!< scan rates in Hz
+
+//_____ F U N C T I O N S ______________________________________________________
+
+//------------------------------------------------------------------------------
+//! @brief   CPU time (user + system) used by the process in seconds
+//------------------------------------------------------------------------------
+static double cpuTime() {
+  struct rusage usage;
+  getrusage( RUSAGE_SELF, &usage );
+  return usage.ru_utime.tv_sec + usage.ru_stime.tv_sec
+    + 1.e-6 * ( usage.ru_utime.tv_usec + usage.ru_stime.tv_usec );
+}
+
+//------------------------------------------------------------------------------
+//! @brief   Scan a set of records at a fixed rate for some time
+//!
+//! Every period all records are read one after the other through
+//! asynFloat64SyncIO, the way periodically scanned ai records go through
+//! the asyn queue. A scan not finished within its period is counted as
+//! overrun and the next one starts immediately.
+//!
+//! @param   [in]  nRecords  number of records
+//! @param   [in]  rate      scan rate in Hz
+//! @param   [in]  duration  duration of the run in seconds
+//! @param   [in]  nModules  number of simulated modules
+//------------------------------------------------------------------------------
+static void runScan( int nRecords, double rate, double duration, int nModules ) {
+  std::vector<asynUser*> records;
+  for( int i = 0; i < nRecords; ++i ) {
+    asynUser *pasynUser = 0;
+    int addr = i % ( nModules * ISEGVDS_NCHANNELS );
+    const char *param = recordParams[( i / ( nModules * ISEGVDS_NCHANNELS ) ) % nRecordParams];
+    if( asynSuccess != pasynFloat64SyncIO->connect( benchPort, addr, &pasynUser, param ) ) {
+      fprintf( stderr, "Cannot connect to %s addr %d param %s\n", benchPort, addr, param );
+      return;
+    }
+    records.push_back( pasynUser );
+  }
+
+  LatencyHistogram latency;
+  unsigned long overruns = 0;
+  const double period = 1. / rate;
+
+  epicsTimeStamp start, now, next;
+  epicsTimeGetCurrent( &start );
+  double cpuStart = cpuTime();
+  next = start;
+  do {
+    for( std::vector<asynUser*>::iterator it = records.begin(); it != records.end(); ++it ) {
+      epicsTimeStamp t0;
+      epicsTimeGetCurrent( &t0 );
+      epicsFloat64 value;
+      if( asynSuccess == pasynFloat64SyncIO->read( *it, &value, 1. ) ) latency.add( t0 );
+      else latency.addError();
+    }
+    epicsTimeAddSeconds( &next, period );
+    epicsTimeGetCurrent( &now );
+    double wait = epicsTimeDiffInSeconds( &next, &now );
+    if( wait > 0. ) epicsThreadSleep( wait );
+    else {
+      ++overruns;
+      next = now;
+    }
+    epicsTimeGetCurrent( &now );
+  } while( epicsTimeDiffInSeconds( &now, &start ) < duration );
+  double wall = epicsTimeDiffInSeconds( &now, &start );
+  double cpu  = cpuTime() - cpuStart;
+
+  printf( "%8d %8.1f %10.0f %8lu %8lu %8.1f %8.1f %8.1f %8.1f %6.1f\n",
+          nRecords, rate, latency.count() / wall, latency.errors(), overruns,
+          latency.min(), latency.average(), latency.percentile( 0.99 ), latency.max(),
+          100. * cpu / wall );
+
+  for( std::vector<asynUser*>::iterator it = records.begin(); it != records.end(); ++it )
+    pasynFloat64SyncIO->disconnect( *it );
+}
+
+//------------------------------------------------------------------------------
+//! @brief   Benchmark of the driver against a simulated VME master
+//!
+//! Usage: drvAsynIsegVdsBench [duration] [latency] [errorRate] [modules]
+//!   duration   seconds per sweep point (default 5)
+//!   latency    simulated duration of one VME cycle in us (default 2)
+//!   errorRate  fraction of failing VME cycles (default 0)
+//!   modules    number of simulated modules (default 4)
+//------------------------------------------------------------------------------
+int main( int argc, char *argv[] ) {
+  double duration  = ( argc > 1 ) ? atof( argv[1] ) : 5.;
+  double latencyUs = ( argc > 2 ) ? atof( argv[2] ) : 2.;
+  double errorRate = ( argc > 3 ) ? atof( argv[3] ) : 0.;
+  int    nModules  = ( argc > 4 ) ? atoi( argv[4] ) : 4;
+  if( duration <= 0. || nModules <= 0 || nModules > 16 ) {
+    fprintf( stderr, "Usage: %s [duration] [latency] [errorRate] [modules]\n", argv[0] );
+    return 1;
+  }
+
+  char bases[16 * 8];
+  int pos = 0;
+  for( int i = 0; i < nModules; ++i )
+    pos += sprintf( bases + pos, "%s0x%x", i ? "," : "", 0x4000 + 0x400 * i );
+
+  if( vmeMockConfigure( benchLink, latencyUs, errorRate ) ) return 1;
+  if( drvAsynIsegVdsCrateConfigure( benchPort, bases, 1., benchLink ) ) return 1;
+  // there is no iocInit seeding the parameters and ending the init phase
+  drvAsynIsegVds *pDrv = (drvAsynIsegVds*)findAsynPortDriver( benchPort );
+  pDrv->seedParameters();
+  pDrv->endInitPhase();
+
+  printf( "%d modules, %g us per VME cycle, error rate %g, %g s per point\n",
+          nModules, latencyUs, errorRate, duration );
+  printf( "%8s %8s %10s %8s %8s %8s %8s %8s %8s %6s\n", "records", "rate/Hz", "ops/s", "errors",
+          "overrun", "min/us", "avg/us", "p99/us", "max/us", "cpu/%" );
+  for( size_t i = 0; i < sizeof( recordCounts ) / sizeof( recordCounts[0] ); ++i )
+    for( size_t j = 0; j < sizeof( scanRates ) / sizeof( scanRates[0] ); ++j )
+      runScan( recordCounts[i], scanRates[j], duration, nModules );
+
+  return 0;
+}
@@ -0,0 +1,142 @@
+//******************************************************************************
+// Copyright (C) 2014 Florian Feldbauer <florian@ep1.ruhr-uni-bochum.de>
+//                    - Helmholtz-Institut/University Mainz, Institute for nuclear physics
+//
+// This file is part of drvAsynIsegVds
+//
+// drvAsynIsegVds is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// drvAsynIsegVds is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+//
+// version 1.0.0; Aug. 15, 2014
+//******************************************************************************
+
+//_____ I N C L U D E S _______________________________________________________
+
+// ANSI C/C++ includes
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+// EPICS includes
+#include <epicsTime.h>
+
+// local includes
+#include "RegisterImage.h"
+
+//_____ D E F I N I T I O N S __________________________________________________
+
+//_____ G L O B A L S __________________________________________________________
+
+//_____ L O C A L S ____________________________________________________________
+
+//_____ F U N C T I O N S ______________________________________________________
+
+//------------------------------------------------------------------------------
+//! @brief   Read an image file and print the reason if it fails
+//------------------------------------------------------------------------------
+static bool readImage( const char *path, RegisterImage& image ) {
+  std::string error;
+  if( image.read( path, error ) ) return true;
+  fprintf( stderr, "%s: %s\n", path, error.c_str() );
+  return false;
+}
+
+//------------------------------------------------------------------------------
+//! @brief   Print the header of an image file
+//------------------------------------------------------------------------------
+static void printHeader( const char *path, const RegisterImage& image ) {
+  const registerImageHeader& header = image.header();
+  epicsTimeStamp saved = { header.secPastEpoch, header.nsec };
+  char when[64];
+  epicsTimeToStrftime( when, sizeof( when ), "%Y-%m-%d %H:%M:%S.%03f", &saved );
+  printf( "%s: version %u, layout 0x%08x, %u module(s) of %u channels, saved %s\n",
+          path, header.version, header.layout, header.modules, header.channels, when );
+}
+
+//------------------------------------------------------------------------------
+//! @brief   Print all register words of an image file
+//------------------------------------------------------------------------------
+static int dump( const char *path ) {
+  RegisterImage image;
+  if( !readImage( path, image ) ) return 2;
+
+  printHeader( path, image );
+  for( size_t module = 0; module < image.header().modules; ++module ) {
+    printf( "module %lu: BA 0x%04x%s\n", (unsigned long)module, image.base( module ),
+            image.valid( module ) ? "" : ", not read" );
+    if( !image.valid( module ) ) continue;
+    const epicsUInt32 *words = image.moduleBlock( module );
+    for( size_t i = 0; i < image.wordsPerModule(); ++i )
+      printf( "  0x%04x 0x%08x\n", image.base( module ) + image.vmeAddress( i ), words[i] );
+  }
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+//! @brief   Print the register words which differ between two image files
+//!
+//! Modules are matched by their base address.
+//!
+//! @return  0 if the images are equal, 1 if they differ
+//------------------------------------------------------------------------------
+static int diff( const char *pathA, const char *pathB ) {
+  RegisterImage a, b;
+  if( !readImage( pathA, a ) || !readImage( pathB, b ) ) return 2;
+  printHeader( pathA, a );
+  printHeader( pathB, b );
+  if( !a.compatible( b ) ) {
+    printf( "register layouts differ\n" );
+    return 1;
+  }
+
+  int rc = 0;
+  for( size_t module = 0; module < a.header().modules; ++module ) {
+    int other = b.findModule( a.base( module ) );
+    bool validA = a.valid( module ) != 0;
+    bool validB = other >= 0 && b.valid( other );
+    if( !validA && !validB ) continue;
+    if( !validA || !validB ) {
+      printf( "module BA 0x%04x: only read in %s\n", a.base( module ), validA ? pathA : pathB );
+      rc = 1;
+      continue;
+    }
+    const epicsUInt32 *wordsA = a.moduleBlock( module );
+    const epicsUInt32 *wordsB = b.moduleBlock( other );
+    for( size_t i = 0; i < a.wordsPerModule(); ++i ) {
+      if( wordsA[i] == wordsB[i] ) continue;
+      printf( "  0x%04x 0x%08x -> 0x%08x\n", a.base( module ) + a.vmeAddress( i ), wordsA[i], wordsB[i] );
+      rc = 1;
+    }
+  }
+  for( size_t module = 0; module < b.header().modules; ++module )
+    if( a.findModule( b.base( module ) ) < 0 && b.valid( module ) ) {
+      printf( "module BA 0x%04x: only read in %s\n", b.base( module ), pathB );
+      rc = 1;
+    }
+  return rc;
+}
+
+//------------------------------------------------------------------------------
+//! @brief   Dump or compare register image files of drvAsynIsegVds
+//!
+//! Usage: drvAsynIsegVdsImage dump <file>
+//!        drvAsynIsegVdsImage diff <file> <file>
+//------------------------------------------------------------------------------
+int main( int argc, char *argv[] ) {
+  if( argc == 3 && !strcmp( argv[1], "dump" ) ) return dump( argv[2] );
+  if( argc == 4 && !strcmp( argv[1], "diff" ) ) return diff( argv[2], argv[3] );
+  fprintf( stderr, "Usage: %s dump <file>\n"
+                   "       %s diff <file> <file>\n", argv[0], argv[0] );
+  return 2;
+}
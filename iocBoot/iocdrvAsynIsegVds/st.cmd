@@ -6,8 +6,42 @@
 dbLoadDatabase "$(TOP)/dbd/drvAsynIsegVds.dbd"
 drvAsynIsegVds_registerRecordDeviceDriver pdbbase
 
-## Load ISEG VDS driver
-drvAsynIsegVdsConfigure( "isegvds0", "/tmp/sis1100", 0x4000 )
+## Open VME master (link name, device, 1: memory mapped A16 reads), the first link is the default
+## (the drivers reconnect a lost link, vmeMasterReconnect( "link0" ) forces a retry)
+SIS3100Configure( "link0", "/dev/sis1100_00remote" )
+#SIS3100Configure( "link1", "/dev/sis1100_01remote", 1 )
+## or simulate modules without hardware (link name, latency per cycle in us, error rate)
+#vmeMockConfigure( "sim", 2.0, 0.0 )
+## only populate some module windows of the simulated link, channel load in Ohm and Vmom/Imom noise
+#vmeMockSetModules( "sim", "0x4000,0x4400,0x4800" )
+#vmeMockSetLoad( "sim", 1.e8, 1.e-4 )
+## record all register traffic of link0 to a file (new link name, recorded link, file)
+#vmeRecordConfigure( "rec0", "link0", "link0.rec" )
+## or replay a recording without hardware (link name, file, latency per cycle in us)
+#vmeReplayConfigure( "replay", "link0.rec", 2.0 )
+
+## Load ISEG VDS driver (port name, base address, poll period in seconds, link)
+drvAsynIsegVdsConfigure( "isegvds0", 0x4000, 1.0, "link0" )
+## or serve several modules of a crate by one port (module m at asyn address m*8 ... m*8+7)
+#drvAsynIsegVdsCrateConfigure( "isegvds1", "0x4000,0x4400,0x4800", 1.0, "link1" )
+
+## Poll ramping channels every 0.05 s, all registers every 5 s
+#drvAsynIsegVdsSetPollRates( "isegvds0", 0.05, 5.0 )
+## Call back single writes once per poll cycle instead of on each write
+#drvAsynIsegVdsSetCoalescing( "isegvds0", 1 )
+## Write bursts of VoltageSet once per 0.1 s with one verify read
+#drvAsynIsegVdsSetWriteWindow( "isegvds0", "VoltageSet", 0.1 )
+## Read all channels of a module with the link locked once and one time stamp (port, enable, time event),
+## A16 has no block transfer, this needs the mapped A16 space of SIS3100Configure
+#drvAsynIsegVdsSetSnapshotMode( "isegvds0", 1, 0 )
+## Keep a history of Vmom/Imom (port, samples per channel, publish period in seconds),
+## load iseg_vds_history.db with NELM=samples for each channel
+#drvAsynIsegVdsSetHistory( "isegvds0", 1000, 1.0 )
+## Seed the parameters from a register image file at iocInit, save it every 60 s and on exit
+#drvAsynIsegVdsSetImageFile( "isegvds0", "isegvds0.img", 60.0 )
+
+## React on module events (port, event status poll period in seconds, VME IRQ level or 0)
+#drvAsynIsegVdsSetEventMode( "isegvds0", 0.01, 0 )
 
 ## Load record instances
 dbLoadRecords( "$(TOP)/db/iseg_vds.db", "" )